@@ -0,0 +1,55 @@
+-- per-box cost for each rotation input, drop into reframework/autorun
+-- results are written to the reframework log
+
+local count = 1000
+local frames = 120
+local color = 0x40FFFFFF
+local color_outline = 0xFFFFFFFF
+
+local function get_camera_front()
+    local camera = sdk.get_primary_camera()
+    local transform = camera:call("get_GameObject"):call("get_Transform")
+    local pos = transform:call("get_Position")
+    local forward = transform:call("get_AxisZ")
+    return Vector3f.new(pos.x - forward.x * 10, pos.y - forward.y * 10, pos.z - forward.z * 10)
+end
+
+local quat = Quaternion.new(0.9238795, 0.0, 0.3826834, 0.0)
+local rotations = {
+    { name = "Matrix4x4f", value = quat:to_mat4() },
+    { name = "Quaternion", value = quat },
+}
+
+local state = { rot = 1, frame = 0, time = 0 }
+local positions
+
+re.on_frame(function()
+    if state.rot > #rotations then
+        return
+    end
+
+    if not positions then
+        local center = get_camera_front()
+        positions = {}
+        for i = 1, count do
+            positions[i] = Vector3f.new(center.x + (i % 32) * 0.3 - 5, center.y + math.floor(i / 32) * 0.3 - 5, center.z)
+        end
+    end
+
+    local rot = rotations[state.rot]
+    local extent = Vector3f.new(0.1, 0.1, 0.1)
+    local start = os.clock()
+    for i = 1, count do
+        hb_draw.box(positions[i], extent, rot.value, color, true, color_outline)
+    end
+    state.time = state.time + os.clock() - start
+    state.frame = state.frame + 1
+
+    if state.frame < frames then
+        return
+    end
+
+    log.info(string.format("[hb_draw bench] box %s: %.3f us/box", rot.name, state.time / (count * frames) * 1e6))
+    state.frame, state.time = 0, 0
+    state.rot = state.rot + 1
+end)
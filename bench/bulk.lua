@@ -0,0 +1,85 @@
+-- per-call vs bulk submission benchmark, drop into reframework/autorun
+-- results are written to the reframework log once every count is measured
+
+local counts = { 1, 100, 10000 }
+local frames = 120
+local color = 0x40FFFFFF
+local color_outline = 0xFFFFFFFF
+
+local function get_camera_front()
+    local camera = sdk.get_primary_camera()
+    local transform = camera:call("get_GameObject"):call("get_Transform")
+    local pos = transform:call("get_Position")
+    local forward = transform:call("get_AxisZ")
+    return Vector3f.new(pos.x - forward.x * 10, pos.y - forward.y * 10, pos.z - forward.z * 10)
+end
+
+local function make_shapes(count, center)
+    local records = {}
+    local flat = {}
+    local rot = Matrix4x4f.identity()
+    local extent = Vector3f.new(0.25, 0.25, 0.25)
+    for i = 1, count do
+        local pos = Vector3f.new(center.x + (i % 100) * 0.1 - 5, center.y + math.floor(i / 100) * 0.1 - 5, center.z)
+        records[i] = { pos, extent, rot, color, true, color_outline }
+
+        local n = #flat
+        flat[n + 1], flat[n + 2], flat[n + 3] = pos.x, pos.y, pos.z
+        flat[n + 4], flat[n + 5], flat[n + 6] = extent.x, extent.y, extent.z
+        for c = 0, 3 do
+            for r = 0, 3 do
+                flat[#flat + 1] = c == r and 1 or 0
+            end
+        end
+        flat[#flat + 1], flat[#flat + 2], flat[#flat + 3] = color, 1, color_outline
+    end
+    return records, flat
+end
+
+local modes = {
+    {
+        name = "per-call",
+        run = function(records)
+            for i = 1, #records do
+                local r = records[i]
+                hb_draw.box(r[1], r[2], r[3], r[4], r[5], r[6])
+            end
+        end,
+    },
+    { name = "records", run = function(records) hb_draw.boxes(records) end },
+    { name = "flat", run = function(_, flat) hb_draw.boxes(flat) end },
+}
+
+local state = { count = 1, mode = 1, frame = 0, time = 0 }
+local records, flat
+
+re.on_frame(function()
+    if state.count > #counts then
+        return
+    end
+
+    local count = counts[state.count]
+    if not records then
+        records, flat = make_shapes(count, get_camera_front())
+    end
+
+    local mode = modes[state.mode]
+    local start = os.clock()
+    mode.run(records, flat)
+    state.time = state.time + os.clock() - start
+    state.frame = state.frame + 1
+
+    if state.frame < frames then
+        return
+    end
+
+    log.info(string.format("[hb_draw bench] %s %d shapes: %.0f shapes/s", mode.name, count,
+        count * frames / state.time))
+    state.frame, state.time = 0, 0
+    state.mode = state.mode + 1
+    if state.mode > #modes then
+        state.mode = 1
+        state.count = state.count + 1
+        records, flat = nil, nil
+    end
+end)
@@ -0,0 +1,555 @@
+#include "reframework/API.hpp"
+#include "reframework/Math.hpp"
+
+#include "fake_reframework.h"
+
+#include <glm/ext/matrix_clip_space.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+using ManagedObject = reframework::API::ManagedObject;
+
+enum class method_id : size_t {
+    get_main_view,
+    get_current_scene,
+    get_primary_camera,
+    get_window_size,
+    get_projection_matrix,
+    get_view_matrix,
+    get_game_object,
+    get_transform,
+    transform_get_position,
+    transform_get_rotation,
+    transform_get_axis_y,
+    transform_get_axis_z,
+    get_joint_by_name,
+    joint_get_position,
+    joint_get_rotation,
+    world_pos_2_screen_pos,
+    convert_world_pos_2_projected_screen_pos,
+    nullable_size_ctor,
+    nullable_size_get_has_value,
+    get_using_frame_generation,
+    count
+};
+
+struct fake_type;
+
+struct method {
+    fake_type *declaring;
+    // as looked up, overloads include their signature
+    std::string name;
+    // type.method, for get_calls_by_method
+    std::string full_name;
+    method_id id;
+    void *function;
+};
+
+struct field {
+    std::string name;
+    unsigned offset;
+};
+
+struct fake_type {
+    std::string name;
+    unsigned size;
+    std::deque<method> methods;
+    std::vector<field> fields;
+    // native singleton instance
+    void *instance;
+};
+
+// every managed object the fake hands out, only the members of its kind are
+// used
+struct object {
+    fake_type *type;
+    // transforms and joints
+    Vector4f position{};
+    glm::quat rotation{1.0f, 0.0f, 0.0f, 0.0f};
+    std::vector<std::pair<std::string, object *>> joints;
+    // System.String
+    std::string string;
+    // value types, fields point into it
+    alignas(16) std::array<uint8_t, 32> value{};
+};
+
+std::deque<fake_type> g_types;
+std::deque<object> g_objects;
+std::array<const method *, (size_t)method_id::count> g_methods{};
+std::array<uint64_t, (size_t)method_id::count> g_calls{};
+std::chrono::nanoseconds g_latency{};
+bool g_frame_gen{};
+
+fake_reframework::camera g_camera{};
+Matrix4x4f g_view{1.0f};
+Matrix4x4f g_proj{1.0f};
+
+object *g_scene_manager{};
+object *g_scene{};
+object *g_main_view{};
+object *g_camera_object{};
+object *g_camera_game_object{};
+object *g_camera_transform{};
+object *g_upscaling{};
+
+int g_vm_context{};
+
+void invoked(method_id id) {
+    g_calls[(size_t)id]++;
+    if (g_latency.count() <= 0) {
+        return;
+    }
+
+    const auto end = std::chrono::steady_clock::now() + g_latency;
+    while (std::chrono::steady_clock::now() < end) {
+    }
+}
+
+// what via.math worldPos2ScreenPos computes, top left origin
+Vector2f project(const Matrix4x4f &view, const Matrix4x4f &proj,
+                 const Vector4f &pos, const Vector2f &size) {
+    const auto clip = proj * view * Vector4f{Vector3f{pos}, 1.0f};
+    const auto ndc = Vector2f{clip.x, clip.y} / clip.w;
+    return {(ndc.x * 0.5f + 0.5f) * size.x, (0.5f - ndc.y * 0.5f) * size.y};
+}
+
+object *new_object(fake_type *type) {
+    auto &ret = g_objects.emplace_back();
+    ret.type = type;
+    return &ret;
+}
+
+fake_type *find_type(std::string_view name) {
+    for (auto &type : g_types) {
+        if (type.name == name) {
+            return &type;
+        }
+    }
+    return nullptr;
+}
+
+// lookups without a signature match the first overload
+const method *find_method(const fake_type *type, std::string_view name) {
+    if (type == nullptr) {
+        return nullptr;
+    }
+
+    for (const auto &method : type->methods) {
+        const std::string_view method_name = method.name;
+        if (method_name == name ||
+            (name.find('(') == std::string_view::npos &&
+             method_name.substr(0, method_name.find('(')) == name)) {
+            return &method;
+        }
+    }
+    return nullptr;
+}
+
+void *get_main_view(void *, void *) {
+    invoked(method_id::get_main_view);
+    return g_main_view;
+}
+
+void *get_current_scene(void *, void *) {
+    invoked(method_id::get_current_scene);
+    return g_scene;
+}
+
+void *get_primary_camera(void *, void *) {
+    invoked(method_id::get_primary_camera);
+    return g_camera_object;
+}
+
+void *get_window_size(float *out, void *, void *) {
+    invoked(method_id::get_window_size);
+    out[0] = g_camera.screen_size.x;
+    out[1] = g_camera.screen_size.y;
+    return nullptr;
+}
+
+void *get_projection_matrix(Matrix4x4f *out, void *, void *) {
+    invoked(method_id::get_projection_matrix);
+    *out = g_proj;
+    return nullptr;
+}
+
+void *get_view_matrix(Matrix4x4f *out, void *, void *) {
+    invoked(method_id::get_view_matrix);
+    *out = g_view;
+    return nullptr;
+}
+
+void *get_game_object(void *, void *) {
+    invoked(method_id::get_game_object);
+    return g_camera_game_object;
+}
+
+void *get_transform(void *, void *) {
+    invoked(method_id::get_transform);
+    return g_camera_transform;
+}
+
+Vector4f transform_get_position(void *, object *obj) {
+    invoked(method_id::transform_get_position);
+    return obj->position;
+}
+
+glm::quat transform_get_rotation(void *, object *obj) {
+    invoked(method_id::transform_get_rotation);
+    return obj->rotation;
+}
+
+Vector4f transform_get_axis_y(void *, object *obj) {
+    invoked(method_id::transform_get_axis_y);
+    return Vector4f{obj->rotation * Vector3f{0.0f, 1.0f, 0.0f}, 0.0f};
+}
+
+Vector4f transform_get_axis_z(void *, object *obj) {
+    invoked(method_id::transform_get_axis_z);
+    return Vector4f{obj->rotation * Vector3f{0.0f, 0.0f, 1.0f}, 0.0f};
+}
+
+void *get_joint_by_name(void *, object *transform, object *name) {
+    invoked(method_id::get_joint_by_name);
+    for (const auto &[joint_name, joint] : transform->joints) {
+        if (joint_name == name->string) {
+            return joint;
+        }
+    }
+    return nullptr;
+}
+
+Vector4f joint_get_position(void *, object *obj) {
+    invoked(method_id::joint_get_position);
+    return obj->position;
+}
+
+glm::quat joint_get_rotation(void *, object *obj) {
+    invoked(method_id::joint_get_rotation);
+    return obj->rotation;
+}
+
+void *world_pos_2_screen_pos(Vector2f *out, void *, const Vector4f *pos,
+                             const Matrix4x4f *view, const Matrix4x4f *proj,
+                             const float *size) {
+    invoked(method_id::world_pos_2_screen_pos);
+    *out = project(*view, *proj, *pos, Vector2f{size[0], size[1]});
+    return nullptr;
+}
+
+void *convert_world_pos_2_projected_screen_pos(Vector2f *out, void *,
+                                               const Vector4f *pos, void *) {
+    invoked(method_id::convert_world_pos_2_projected_screen_pos);
+    *out = project(g_view, g_proj, *pos, g_camera.screen_size);
+    return nullptr;
+}
+
+// the value type argument is passed by reference on every abi hb_draw
+// targets, it is left untouched
+void *nullable_size_ctor(void *, void *, void *) {
+    invoked(method_id::nullable_size_ctor);
+    return nullptr;
+}
+
+bool nullable_size_get_has_value(void *) {
+    invoked(method_id::nullable_size_get_has_value);
+    return true;
+}
+
+bool get_using_frame_generation(void *, void *) {
+    invoked(method_id::get_using_frame_generation);
+    return g_frame_gen;
+}
+
+fake_type &add_type(std::string name, unsigned size = 0) {
+    auto &ret = g_types.emplace_back();
+    ret.name = std::move(name);
+    ret.size = size;
+    return ret;
+}
+
+template <typename F>
+void add_method(fake_type &type, std::string name, method_id id, F function) {
+    auto &method = type.methods.emplace_back();
+    method.declaring = &type;
+    method.full_name = type.name + "." + name;
+    method.name = std::move(name);
+    method.id = id;
+    method.function = (void *)function;
+    g_methods[(size_t)id] = &method;
+}
+
+void add_types() {
+    auto &scene_manager = add_type("via.SceneManager");
+    add_method(scene_manager, "get_MainView", method_id::get_main_view,
+               get_main_view);
+    add_method(scene_manager, "get_CurrentScene", method_id::get_current_scene,
+               get_current_scene);
+    g_scene_manager = new_object(&scene_manager);
+    scene_manager.instance = g_scene_manager;
+
+    g_scene = new_object(&add_type("via.Scene"));
+
+    auto &scene_view = add_type("via.SceneView");
+    add_method(scene_view, "get_PrimaryCamera", method_id::get_primary_camera,
+               get_primary_camera);
+    add_method(scene_view, "get_WindowSize", method_id::get_window_size,
+               get_window_size);
+    g_main_view = new_object(&scene_view);
+
+    auto &camera = add_type("via.Camera");
+    add_method(camera, "get_ProjectionMatrix", method_id::get_projection_matrix,
+               get_projection_matrix);
+    add_method(camera, "get_ViewMatrix", method_id::get_view_matrix,
+               get_view_matrix);
+    g_camera_object = new_object(&camera);
+
+    auto &game_object = add_type("via.GameObject");
+    add_method(game_object, "get_Transform", method_id::get_transform,
+               get_transform);
+    g_camera_game_object = new_object(&game_object);
+
+    auto &transform = add_type("via.Transform");
+    add_method(transform, "get_GameObject", method_id::get_game_object,
+               get_game_object);
+    add_method(transform, "get_Position", method_id::transform_get_position,
+               transform_get_position);
+    add_method(transform, "get_Rotation", method_id::transform_get_rotation,
+               transform_get_rotation);
+    add_method(transform, "get_AxisY", method_id::transform_get_axis_y,
+               transform_get_axis_y);
+    add_method(transform, "get_AxisZ", method_id::transform_get_axis_z,
+               transform_get_axis_z);
+    add_method(transform, "getJointByName(System.String)",
+               method_id::get_joint_by_name, get_joint_by_name);
+    g_camera_transform = new_object(&transform);
+
+    auto &joint = add_type("via.Joint");
+    add_method(joint, "get_Position", method_id::joint_get_position,
+               joint_get_position);
+    add_method(joint, "get_Rotation", method_id::joint_get_rotation,
+               joint_get_rotation);
+
+    add_method(add_type("via.math"),
+               "worldPos2ScreenPos(via.vec3, via.mat4, via.mat4, via.Size)",
+               method_id::world_pos_2_screen_pos, world_pos_2_screen_pos);
+    add_method(add_type("ace.CameraUtil"),
+               "convertWorldPos2ProjectedScreenPos(via.vec3, "
+               "System.Nullable`1<via.Size>)",
+               method_id::convert_world_pos_2_projected_screen_pos,
+               convert_world_pos_2_projected_screen_pos);
+
+    auto &size = add_type("via.Size", 8);
+    size.fields = {{"w", 0}, {"h", 4}};
+    auto &nullable_size = add_type("System.Nullable`1<via.Size>", 12);
+    add_method(nullable_size, ".ctor(via.Size)", method_id::nullable_size_ctor,
+               nullable_size_ctor);
+    add_method(nullable_size, "get_HasValue()",
+               method_id::nullable_size_get_has_value,
+               nullable_size_get_has_value);
+
+    auto &upscaling = add_type("via.render.UpscalingInterface");
+    add_method(upscaling, "get_UsingFrameGeneration",
+               method_id::get_using_frame_generation,
+               get_using_frame_generation);
+    g_upscaling = new_object(&upscaling);
+    upscaling.instance = g_upscaling;
+
+    add_type("System.String");
+}
+
+// c tables behind reframework::API, only what scene.cpp reaches is filled
+REFrameworkSDKFunctions g_functions{};
+REFrameworkTDB g_tdb{};
+REFrameworkTDBTypeDefinition g_type_definition{};
+REFrameworkTDBMethod g_method{};
+REFrameworkTDBField g_field{};
+REFrameworkTDBProperty g_property{};
+REFrameworkManagedObject g_managed_object{};
+REFrameworkSDKData g_sdk{};
+REFrameworkPluginFunctions g_plugin_functions{};
+REFrameworkPluginVersion g_version{};
+REFrameworkPluginInitializeParam g_param{};
+
+void fill_tables() {
+    g_functions.get_tdb = [] { return (REFrameworkTDBHandle)&g_types; };
+    g_functions.get_vm_context = [] {
+        return (REFrameworkVMContextHandle)&g_vm_context;
+    };
+    g_functions.get_native_singleton = [](const char *name) -> void * {
+        const auto type = find_type(name);
+        return type ? type->instance : nullptr;
+    };
+    g_functions.create_managed_string_normal = [](const char *str) {
+        const auto ret = new_object(find_type("System.String"));
+        ret->string = str;
+        return (REFrameworkManagedObjectHandle)ret;
+    };
+
+    g_tdb.find_type = [](REFrameworkTDBHandle, const char *name) {
+        return (REFrameworkTypeDefinitionHandle)find_type(name);
+    };
+    g_tdb.find_method = [](REFrameworkTDBHandle, const char *type_name,
+                           const char *name) {
+        return (REFrameworkMethodHandle)find_method(find_type(type_name),
+                                                    name);
+    };
+
+    g_type_definition.get_size = [](REFrameworkTypeDefinitionHandle t) {
+        return ((fake_type *)t)->size;
+    };
+    g_type_definition.get_valuetype_size =
+        [](REFrameworkTypeDefinitionHandle t) {
+            return ((fake_type *)t)->size;
+        };
+    g_type_definition.get_name = [](REFrameworkTypeDefinitionHandle t) {
+        return ((fake_type *)t)->name.c_str();
+    };
+    g_type_definition.find_method = [](REFrameworkTypeDefinitionHandle t,
+                                       const char *name) {
+        return (REFrameworkMethodHandle)find_method((fake_type *)t, name);
+    };
+    g_type_definition.find_field = [](REFrameworkTypeDefinitionHandle t,
+                                      const char *name) {
+        for (auto &field : ((fake_type *)t)->fields) {
+            if (field.name == name) {
+                return (REFrameworkFieldHandle)&field;
+            }
+        }
+        return (REFrameworkFieldHandle) nullptr;
+    };
+    g_type_definition.get_instance = [](REFrameworkTypeDefinitionHandle t) {
+        return ((fake_type *)t)->instance;
+    };
+    g_type_definition.create_instance = [](REFrameworkTypeDefinitionHandle t,
+                                           unsigned int) {
+        return (REFrameworkManagedObjectHandle)new_object((fake_type *)t);
+    };
+
+    g_method.get_function = [](REFrameworkMethodHandle m) {
+        return ((method *)m)->function;
+    };
+    g_method.get_name = [](REFrameworkMethodHandle m) {
+        return ((method *)m)->name.c_str();
+    };
+    g_method.get_declaring_type = [](REFrameworkMethodHandle m) {
+        return (REFrameworkTypeDefinitionHandle)((method *)m)->declaring;
+    };
+
+    g_field.get_name = [](REFrameworkFieldHandle f) {
+        return ((field *)f)->name.c_str();
+    };
+    g_field.get_data_raw = [](REFrameworkFieldHandle f, void *obj,
+                              bool is_value_type) -> void * {
+        const auto data = is_value_type ? (uint8_t *)obj
+                                        : ((object *)obj)->value.data();
+        return data + ((field *)f)->offset;
+    };
+
+    g_managed_object.get_type_definition =
+        [](REFrameworkManagedObjectHandle obj) {
+            return (REFrameworkTypeDefinitionHandle)((object *)obj)->type;
+        };
+    g_managed_object.is_managed_object = [](void *obj) {
+        return obj != nullptr;
+    };
+    g_managed_object.add_ref = [](REFrameworkManagedObjectHandle) {};
+    g_managed_object.release = [](REFrameworkManagedObjectHandle) {};
+
+    g_plugin_functions.lock_lua = [] {};
+    g_plugin_functions.unlock_lua = [] {};
+
+    g_sdk.functions = &g_functions;
+    g_sdk.tdb = &g_tdb;
+    g_sdk.type_definition = &g_type_definition;
+    g_sdk.method = &g_method;
+    g_sdk.field = &g_field;
+    g_sdk.property = &g_property;
+    g_sdk.managed_object = &g_managed_object;
+
+    g_param.version = &g_version;
+    g_param.functions = &g_plugin_functions;
+    g_param.sdk = &g_sdk;
+}
+} // namespace
+
+void fake_reframework::initialize(const char *game_name) {
+    add_types();
+    fill_tables();
+    g_version.major = REFRAMEWORK_PLUGIN_VERSION_MAJOR;
+    g_version.minor = REFRAMEWORK_PLUGIN_VERSION_MINOR;
+    g_version.patch = REFRAMEWORK_PLUGIN_VERSION_PATCH;
+    g_version.game_name = game_name;
+    reframework::API::initialize(&g_param);
+    set_camera(g_camera);
+}
+
+void fake_reframework::set_camera(const camera &camera) {
+    g_camera = camera;
+    g_view = glm::lookAt(camera.position, camera.target, camera.up);
+    g_proj = glm::perspective(
+        camera.fov_y, camera.screen_size.x / camera.screen_size.y, 0.1f,
+        1000.0f);
+
+    // engine cameras look down -z
+    const auto back = glm::normalize(camera.position - camera.target);
+    const auto right = glm::normalize(glm::cross(camera.up, back));
+    const auto up = glm::cross(back, right);
+    g_camera_transform->position = Vector4f{camera.position, 1.0f};
+    g_camera_transform->rotation =
+        glm::quat_cast(Matrix3x3f{right, up, back});
+}
+
+void fake_reframework::set_frame_gen(bool enabled) { g_frame_gen = enabled; }
+
+void fake_reframework::set_latency(std::chrono::nanoseconds latency) {
+    g_latency = latency;
+}
+
+ManagedObject *fake_reframework::create_transform(const Vector3f &pos,
+                                                  const glm::quat &rot) {
+    const auto ret = new_object(find_type("via.Transform"));
+    ret->position = Vector4f{pos, 1.0f};
+    ret->rotation = rot;
+    return (ManagedObject *)ret;
+}
+
+ManagedObject *fake_reframework::create_joint(ManagedObject *transform,
+                                              const char *name,
+                                              const Vector3f &pos,
+                                              const glm::quat &rot) {
+    const auto ret = new_object(find_type("via.Joint"));
+    ret->position = Vector4f{pos, 1.0f};
+    ret->rotation = rot;
+    ((object *)transform)->joints.emplace_back(name, ret);
+    return (ManagedObject *)ret;
+}
+
+uint64_t fake_reframework::get_calls() {
+    uint64_t ret = 0;
+    for (const auto calls : g_calls) {
+        ret += calls;
+    }
+    return ret;
+}
+
+std::vector<std::pair<std::string_view, uint64_t>>
+fake_reframework::get_calls_by_method() {
+    std::vector<std::pair<std::string_view, uint64_t>> ret;
+    for (size_t i = 0; i < g_calls.size(); i++) {
+        if (g_calls[i] > 0) {
+            ret.emplace_back(g_methods[i]->full_name, g_calls[i]);
+        }
+    }
+    return ret;
+}
+
+void fake_reframework::reset_calls() { g_calls = {}; }
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "reframework/API.hpp"
+#include "reframework/Math.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// stand-in for the REFramework plugin api, serves the scene manager, camera,
+// transform and projection methods scene.cpp calls from a synthetic camera.
+// every call into a fake method is counted and can be slowed down to
+// simulate managed call latency
+namespace fake_reframework {
+struct camera {
+    Vector3f position{0.0f, 0.0f, -5.0f};
+    Vector3f target{};
+    Vector3f up{0.0f, 1.0f, 0.0f};
+    float fov_y{glm::radians(60.0f)};
+    Vector2f screen_size{1920.0f, 1080.0f};
+};
+
+// installs the fake as reframework::API, once per process
+void initialize(const char *game_name = "MHWILDS");
+void set_camera(const camera &camera);
+void set_frame_gen(bool enabled);
+// busy waits this long in every fake method
+void set_latency(std::chrono::nanoseconds latency);
+
+reframework::API::ManagedObject *create_transform(const Vector3f &pos,
+                                                  const glm::quat &rot);
+// found by getJointByName on transform
+reframework::API::ManagedObject *
+create_joint(reframework::API::ManagedObject *transform, const char *name,
+             const Vector3f &pos, const glm::quat &rot);
+
+// calls into fake methods since the last reset
+uint64_t get_calls();
+// type.method and its call count, only methods that were called
+std::vector<std::pair<std::string_view, uint64_t>> get_calls_by_method();
+void reset_calls();
+} // namespace fake_reframework
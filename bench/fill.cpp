@@ -0,0 +1,286 @@
+// fill cost of every shape, each one is drawn alone through draw::draw_* and
+// the frame rasterized on the cpu
+//
+// > hb_draw_fill [--out results.json] [--images dir] [--golden dir]
+//                [--aliased]
+//
+// --images writes <shape>.png and <shape>_overdraw.png, --golden compares
+// the rendered shapes against <shape>.png in dir and fails on any pixel
+// that differs by more than 2 in a channel. --aliased turns off imgui's
+// anti-aliasing, the fringe it adds changes between imgui versions while the
+// aliased triangles only depend on hb_draw. bench/golden is made with
+// --aliased --images
+
+#include "imgui.h"
+
+#include "core.h"
+#include "draw.h"
+#include "math_types.h"
+#include "projection.h"
+#include "raster.h"
+#include "trail.h"
+
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+const Vector2f screen_size{640.0f, 360.0f};
+const float fov_y = glm::radians(60.0f);
+constexpr ImU32 color = 0x40FFFFFF;
+constexpr ImU32 color_outline = 0xFFFFFFFF;
+// overdraw heat maps saturate here
+constexpr uint32_t max_heat = 8;
+
+struct shape {
+    const char *name;
+    std::function<void()> draw;
+};
+
+struct result {
+    const char *name;
+    raster::metrics metrics;
+    // pixels off by more than the tolerance, -1 without a golden image
+    long long mismatched;
+};
+
+struct options {
+    const char *out{};
+    const char *images{};
+    const char *golden{};
+    bool aliased{};
+};
+
+matrix_projection g_projection{};
+
+void set_camera() {
+    const Vector3f eye{0.0f, 1.5f, -3.0f};
+    const Vector3f target{0.0f, 0.5f, 0.0f};
+    g_projection.view = glm::lookAt(eye, target, Vector3f{0.0f, 1.0f, 0.0f});
+    g_projection.proj =
+        glm::perspective(fov_y, screen_size.x / screen_size.y, 0.1f, 1000.0f);
+    g_projection.origin = eye;
+    // game cameras look down -z, forward points behind them
+    g_projection.forward = glm::normalize(eye - target);
+    g_projection.up = Vector3f{0.0f, 1.0f, 0.0f};
+    g_projection.screen_size = screen_size;
+    g_core.camera_version++;
+}
+
+raster::texture init_imgui() {
+    ImGui::CreateContext();
+    auto &io = ImGui::GetIO();
+    io.DisplaySize = ImVec2{screen_size.x, screen_size.y};
+    io.DeltaTime = 1.0f / 60.0f;
+    raster::texture ret{};
+    io.Fonts->GetTexDataAsRGBA32((unsigned char **)&ret.rgba, &ret.width,
+                                 &ret.height);
+    g_core.projection = &g_projection;
+    return ret;
+}
+
+// half a turn of a helix around the shapes, like a weapon swing
+std::shared_ptr<trail::history> get_trail() {
+    constexpr size_t count = 64;
+    auto ret = std::make_shared<trail::history>(count);
+    for (size_t i = 0; i < count; i++) {
+        const auto a = glm::radians(180.0f) * i / (count - 1);
+        ret->push({Vector3f{std::cos(a) * 0.8f, 0.2f + 0.6f * i / count,
+                            std::sin(a) * 0.8f},
+                   0.2f, color});
+    }
+    return ret;
+}
+
+std::vector<shape> get_shapes() {
+    const Vector3f start{0.0f, 0.0f, 0.0f};
+    const Vector3f end{0.0f, 1.0f, 0.0f};
+    const Vector3f center{0.0f, 0.5f, 0.0f};
+    const Vector3f extent{0.5f, 0.5f, 0.5f};
+    const auto trail = get_trail();
+    const auto rot =
+        glm::angleAxis(glm::radians(30.0f), Vector3f{0.0f, 1.0f, 0.0f}) *
+        glm::angleAxis(glm::radians(20.0f), Vector3f{1.0f, 0.0f, 0.0f});
+
+    return {
+        {"sphere",
+         [=] {
+             draw::draw_sphere(center, 0.5f, color, true, color_outline);
+         }},
+        {"box",
+         [=] {
+             draw::draw_box(center, extent, rot, color, true, color_outline);
+         }},
+        {"triangle",
+         [=] {
+             draw::draw_triangle(center, extent, rot, color, true,
+                                 color_outline);
+         }},
+        {"cylinder",
+         [=] {
+             draw::draw_cylinder(start, end, 0.5f, color, true,
+                                 color_outline);
+         }},
+        {"ring",
+         [=] {
+             draw::draw_ring(start, end, 0.3f, 0.5f, color, true,
+                             color_outline);
+         }},
+        {"capsule",
+         [=] {
+             draw::draw_capsule(start, end, 0.3f, color, true, color_outline);
+         }},
+        {"ellipsoid",
+         [=] {
+             draw::draw_ellipsoid(center, Vector3f{0.5f, 0.3f, 0.2f}, rot,
+                                  color, true, color_outline);
+         }},
+        {"cone",
+         [=] {
+             draw::draw_cone(start, end, 0.5f, 0.0f, color, true,
+                             color_outline);
+         }},
+        {"trail", [=] { draw::draw_trail(*trail); }},
+    };
+}
+
+long long compare(const raster::target &a, const raster::target &b) {
+    if (a.width != b.width || a.height != b.height) {
+        return (long long)a.color.size();
+    }
+    long long ret = 0;
+    for (size_t i = 0; i < a.color.size(); i++) {
+        for (int k = 0; k < 32; k += 8) {
+            const auto ca = (int)((a.color[i] >> k) & 0xFF);
+            const auto cb = (int)((b.color[i] >> k) & 0xFF);
+            if (std::abs(ca - cb) > 2) {
+                ret++;
+                break;
+            }
+        }
+    }
+    return ret;
+}
+
+void write_json(FILE *file, const std::vector<result> &results) {
+    std::fprintf(file, "{\n  \"version\": 1,\n  \"width\": %d, "
+                       "\"height\": %d,\n  \"results\": [\n",
+                 (int)screen_size.x, (int)screen_size.y);
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto &res = results[i];
+        std::fprintf(file,
+                     "    {\"shape\": \"%s\", \"shaded\": %llu, "
+                     "\"covered\": %llu, \"average_overdraw\": %.3f, "
+                     "\"max_overdraw\": %u",
+                     res.name, (unsigned long long)res.metrics.shaded,
+                     (unsigned long long)res.metrics.covered,
+                     res.metrics.average_overdraw, res.metrics.max_overdraw);
+        if (res.mismatched >= 0) {
+            std::fprintf(file, ", \"mismatched\": %lld", res.mismatched);
+        }
+        std::fprintf(file, "}%s\n", i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(file, "  ]\n}\n");
+}
+
+bool parse_options(int argc, char **argv, options &out) {
+    for (int i = 1; i < argc; i++) {
+        const auto has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--out") == 0 && has_value) {
+            out.out = argv[++i];
+        } else if (std::strcmp(argv[i], "--images") == 0 && has_value) {
+            out.images = argv[++i];
+        } else if (std::strcmp(argv[i], "--golden") == 0 && has_value) {
+            out.golden = argv[++i];
+        } else if (std::strcmp(argv[i], "--aliased") == 0) {
+            out.aliased = true;
+        } else {
+            std::fprintf(stderr,
+                         "usage: %s [--out file] [--images dir] "
+                         "[--golden dir] [--aliased]\n",
+                         argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    options options{};
+    if (!parse_options(argc, argv, options)) {
+        return 1;
+    }
+    const auto font = init_imgui();
+    if (options.aliased) {
+        auto &style = ImGui::GetStyle();
+        style.AntiAliasedLines = false;
+        style.AntiAliasedLinesUseTex = false;
+        style.AntiAliasedFill = false;
+    }
+    set_camera();
+
+    raster::target target{};
+    target.resize((int)screen_size.x, (int)screen_size.y);
+    std::vector<result> results;
+    bool ok = true;
+    for (const auto &shape : get_shapes()) {
+        ImGui::NewFrame();
+        g_core.drawlist = ImGui::GetBackgroundDrawList();
+        shape.draw();
+        ImGui::Render();
+
+        target.clear();
+        raster::render(*ImGui::GetDrawData(), target, &font);
+        result res{shape.name, raster::measure(target), -1};
+
+        const std::string name = shape.name;
+        if (options.images) {
+            const std::string dir = options.images;
+            if (!raster::write_png((dir + "/" + name + ".png").c_str(),
+                                   target) ||
+                !raster::write_overdraw_png(
+                    (dir + "/" + name + "_overdraw.png").c_str(), target,
+                    max_heat)) {
+                std::fprintf(stderr, "can not write images of %s\n",
+                             shape.name);
+                ok = false;
+            }
+        }
+        if (options.golden) {
+            raster::target golden{};
+            const auto path =
+                std::string{options.golden} + "/" + name + ".png";
+            if (!raster::read_png(path.c_str(), golden)) {
+                std::fprintf(stderr, "can not read %s\n", path.c_str());
+                ok = false;
+            } else {
+                res.mismatched = compare(target, golden);
+                ok = ok && res.mismatched == 0;
+            }
+        }
+        results.push_back(res);
+    }
+
+    auto file = options.out ? std::fopen(options.out, "w") : stdout;
+    if (file == nullptr) {
+        std::fprintf(stderr, "can not open %s\n", options.out);
+        return 1;
+    }
+    write_json(file, results);
+    if (file != stdout) {
+        std::fclose(file);
+    }
+
+    ImGui::DestroyContext();
+    return ok ? 0 : 1;
+}
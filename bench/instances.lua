@@ -0,0 +1,66 @@
+-- per-box cost of box calls against box_instances, drop into reframework/autorun
+-- results are written to the reframework log
+
+local count = 1000
+local frames = 120
+local color = 0x40FFFFFF
+local color_outline = 0xFFFFFFFF
+
+local function get_camera_front()
+    local camera = sdk.get_primary_camera()
+    local transform = camera:call("get_GameObject"):call("get_Transform")
+    local pos = transform:call("get_Position")
+    local forward = transform:call("get_AxisZ")
+    return Vector3f.new(pos.x - forward.x * 10, pos.y - forward.y * 10, pos.z - forward.z * 10)
+end
+
+local rot = Quaternion.new(0.9238795, 0.0, 0.3826834, 0.0):to_mat4()
+local extent = Vector3f.new(0.1, 0.1, 0.1)
+local positions
+
+local modes = {
+    {
+        name = "box",
+        fn = function()
+            for i = 1, count do
+                hb_draw.box(positions[i], extent, rot, color, true, color_outline)
+            end
+        end,
+    },
+    {
+        name = "box_instances",
+        fn = function()
+            hb_draw.box_instances(extent, rot, positions, color, true, color_outline)
+        end,
+    },
+}
+
+local state = { mode = 1, frame = 0, time = 0 }
+
+re.on_frame(function()
+    if state.mode > #modes then
+        return
+    end
+
+    if not positions then
+        local center = get_camera_front()
+        positions = {}
+        for i = 1, count do
+            positions[i] = Vector3f.new(center.x + (i % 32) * 0.3 - 5, center.y + math.floor(i / 32) * 0.3 - 5, center.z)
+        end
+    end
+
+    local mode = modes[state.mode]
+    local start = os.clock()
+    mode.fn()
+    state.time = state.time + os.clock() - start
+    state.frame = state.frame + 1
+
+    if state.frame < frames then
+        return
+    end
+
+    log.info(string.format("[hb_draw bench] %s: %.3f us/box", mode.name, state.time / (count * frames) * 1e6))
+    state.frame, state.time = 0, 0
+    state.mode = state.mode + 1
+end)
@@ -0,0 +1,237 @@
+// managed calls and time per frame of the camera update, projection and
+// attachment paths in scene.cpp, run against fake_reframework so call counts
+// are reproducible and latency can be dialed in
+//
+// > hb_draw_api_bench [--out results.json] [--frames 200] [--latency-ns 500]
+//
+// calls_per_frame is what the fake served, counted_per_frame what
+// stats::frame::managed_calls reported for the same frames
+
+#include "imgui.h"
+#include "reframework/API.hpp"
+#include "reframework/Math.hpp"
+
+#include "core.h"
+#include "fake_reframework.h"
+#include "plugin.h"
+#include "scene.h"
+#include "stats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// scene.cpp reads the plugin state, plugin.cpp is not part of this build
+hbdraw g_hbdraw{};
+
+namespace {
+using clock_type = std::chrono::steady_clock;
+
+constexpr size_t point_count = 1000;
+constexpr size_t transform_count = 64;
+
+struct scenario {
+    const char *name;
+    std::function<void()> frame;
+};
+
+struct result {
+    std::string scenario;
+    bool w2s;
+    long long latency_ns;
+    double calls_per_frame;
+    double counted_per_frame;
+    double us_per_frame;
+    std::vector<std::pair<std::string_view, uint64_t>> methods;
+};
+
+struct options {
+    const char *out{};
+    size_t frames{200};
+    std::vector<long long> latencies{0, 1000};
+};
+
+struct points {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<Vector2f> out;
+    std::vector<uint8_t> visible;
+};
+
+// grid in front of the default fake camera, some of it off screen
+points make_points() {
+    points ret{};
+    for (size_t i = 0; i < point_count; i++) {
+        ret.x.push_back((float)(i % 40) * 0.5f - 10.0f);
+        ret.y.push_back((float)(i / 40) * 0.5f - 6.0f);
+        ret.z.push_back(5.0f);
+    }
+    ret.out.resize(point_count);
+    ret.visible.resize(point_count);
+    return ret;
+}
+
+std::vector<reframework::API::ManagedObject *> make_transforms() {
+    std::vector<reframework::API::ManagedObject *> ret;
+    for (size_t i = 0; i < transform_count; i++) {
+        ret.push_back(fake_reframework::create_transform(
+            Vector3f{(float)i, 0.0f, 5.0f},
+            glm::quat{1.0f, 0.0f, 0.0f, 0.0f}));
+    }
+    return ret;
+}
+
+result run(const options &options, const scenario &scenario, bool w2s,
+           long long latency_ns) {
+    g_hbdraw.w2s = w2s;
+    // setup_camera differs between w2s and the wilds path
+    g_hbdraw.camera = {};
+    fake_reframework::set_latency(std::chrono::nanoseconds{latency_ns});
+
+    // first frame sets the camera up, it is not part of the steady state
+    stats::clear();
+    scene::update_camera();
+    stats::end_frame(clock_type::now());
+    fake_reframework::reset_calls();
+
+    uint64_t counted = 0;
+    const auto start = clock_type::now();
+    for (size_t i = 0; i < options.frames; i++) {
+        const auto frame_start = clock_type::now();
+        if (scene::update_camera()) {
+            scenario.frame();
+        }
+        stats::end_frame(frame_start);
+        counted += stats::get_history(0)->managed_calls;
+    }
+    const std::chrono::duration<double, std::micro> elapsed =
+        clock_type::now() - start;
+
+    result ret{};
+    ret.scenario = scenario.name;
+    ret.w2s = w2s;
+    ret.latency_ns = latency_ns;
+    ret.calls_per_frame =
+        (double)fake_reframework::get_calls() / options.frames;
+    ret.counted_per_frame = (double)counted / options.frames;
+    ret.us_per_frame = elapsed.count() / options.frames;
+    ret.methods = fake_reframework::get_calls_by_method();
+    return ret;
+}
+
+void write_json(FILE *file, const options &options,
+                const std::vector<result> &results) {
+    std::fprintf(file, "{\n  \"version\": 1,\n  \"frames\": %zu,\n",
+                 options.frames);
+    std::fprintf(file, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto &res = results[i];
+        std::fprintf(file,
+                     "    {\"scenario\": \"%s\", \"w2s\": %s, "
+                     "\"latency_ns\": %lld, \"calls_per_frame\": %.2f, "
+                     "\"counted_per_frame\": %.2f, \"us_per_frame\": %.2f, "
+                     "\"methods\": {",
+                     res.scenario.c_str(), res.w2s ? "true" : "false",
+                     res.latency_ns, res.calls_per_frame,
+                     res.counted_per_frame, res.us_per_frame);
+        for (size_t j = 0; j < res.methods.size(); j++) {
+            const auto &[name, calls] = res.methods[j];
+            std::fprintf(file, "%s\"%.*s\": %.2f", j > 0 ? ", " : "",
+                         (int)name.size(), name.data(),
+                         (double)calls / options.frames);
+        }
+        std::fprintf(file, "}}%s\n", i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(file, "  ]\n}\n");
+}
+
+bool parse_options(int argc, char **argv, options &out) {
+    bool latency_set = false;
+    for (int i = 1; i < argc; i++) {
+        const auto has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--out") == 0 && has_value) {
+            out.out = argv[++i];
+        } else if (std::strcmp(argv[i], "--frames") == 0 && has_value) {
+            out.frames = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--latency-ns") == 0 && has_value) {
+            if (!latency_set) {
+                out.latencies.clear();
+                latency_set = true;
+            }
+            out.latencies.push_back(std::atoll(argv[++i]));
+        } else {
+            std::fprintf(stderr,
+                         "usage: %s [--out file] [--frames n] "
+                         "[--latency-ns ns]...\n",
+                         argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    options options{};
+    if (!parse_options(argc, argv, options)) {
+        return 1;
+    }
+
+    fake_reframework::initialize();
+    g_core.projection = scene::get_projection();
+
+    auto points = make_points();
+    const auto transforms = make_transforms();
+    const std::vector<scenario> scenarios{
+        {"camera", [] {}},
+        {"project_single",
+         [&] {
+             for (size_t i = 0; i < point_count; i++) {
+                 core::world_to_screen(
+                     Vector3f{points.x[i], points.y[i], points.z[i]});
+             }
+         }},
+        {"project_batch",
+         [&] {
+             core::world_to_screen(points.x.data(), points.y.data(),
+                                   points.z.data(), point_count,
+                                   points.out.data(), points.visible.data());
+         }},
+        {"attachments",
+         [&] {
+             Vector3f pos{};
+             glm::quat rot{};
+             for (const auto transform : transforms) {
+                 scene::get_world_transform(transform, false, pos, rot);
+             }
+         }},
+    };
+
+    std::vector<result> results;
+    for (const auto &scenario : scenarios) {
+        for (const auto w2s : {true, false}) {
+            for (const auto latency : options.latencies) {
+                results.push_back(run(options, scenario, w2s, latency));
+            }
+        }
+    }
+
+    auto file = options.out ? std::fopen(options.out, "w") : stdout;
+    if (file == nullptr) {
+        std::fprintf(stderr, "can not open %s\n", options.out);
+        return 1;
+    }
+    write_json(file, options, results);
+    if (file != stdout) {
+        std::fclose(file);
+    }
+    return 0;
+}
@@ -0,0 +1,413 @@
+#include "imgui.h"
+
+#include "raster.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+struct point {
+    float x;
+    float y;
+};
+
+struct rect {
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+};
+
+// positive when p is right of a->b on screen, y points down
+float edge(const point &a, const point &b, const point &p) {
+    return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+}
+
+// fragments on a shared edge go to one triangle only, the one the edge is
+// a top or left edge of
+bool is_top_left(const point &a, const point &b) {
+    return (a.y == b.y && b.x > a.x) || b.y < a.y;
+}
+
+struct rgba {
+    float r;
+    float g;
+    float b;
+    float a;
+};
+
+rgba unpack(ImU32 color) {
+    return {(float)(color & 0xFF), (float)((color >> 8) & 0xFF),
+            (float)((color >> 16) & 0xFF), (float)((color >> 24) & 0xFF)};
+}
+
+ImU32 pack(const rgba &color) {
+    const auto to_byte = [](float v) {
+        return (ImU32)std::clamp((int)std::lround(v), 0, 255);
+    };
+    return to_byte(color.r) | to_byte(color.g) << 8 | to_byte(color.b) << 16 |
+           to_byte(color.a) << 24;
+}
+
+rgba sample(const raster::texture &texture, float u, float v) {
+    const auto x = std::clamp((int)(u * texture.width), 0, texture.width - 1);
+    const auto y =
+        std::clamp((int)(v * texture.height), 0, texture.height - 1);
+    const auto p = texture.rgba + ((size_t)y * texture.width + x) * 4;
+    return {p[0] / 255.0f, p[1] / 255.0f, p[2] / 255.0f, p[3] / 255.0f};
+}
+
+// src alpha, one minus src alpha for color, one, one minus src alpha for
+// alpha, as the dx12 backend sets it up
+void blend(ImU32 &dst, const rgba &src) {
+    const auto d = unpack(dst);
+    const auto a = src.a / 255.0f;
+    dst = pack({src.r * a + d.r * (1.0f - a), src.g * a + d.g * (1.0f - a),
+                src.b * a + d.b * (1.0f - a), src.a + d.a * (1.0f - a)});
+}
+
+void draw_triangle(const std::array<const ImDrawVert *, 3> &vtx,
+                   const ImVec2 &offset, const ImVec2 &scale, const rect &clip,
+                   const raster::texture *texture, raster::target &target) {
+    std::array<point, 3> p{};
+    for (size_t i = 0; i < 3; i++) {
+        p[i] = {(vtx[i]->pos.x - offset.x) * scale.x,
+                (vtx[i]->pos.y - offset.y) * scale.y};
+    }
+
+    auto area = edge(p[0], p[1], p[2]);
+    std::array<size_t, 3> order{0, 1, 2};
+    if (area < 0.0f) {
+        std::swap(order[1], order[2]);
+        area = -area;
+    }
+    if (area == 0.0f) {
+        return;
+    }
+    const auto &a = p[order[0]];
+    const auto &b = p[order[1]];
+    const auto &c = p[order[2]];
+
+    // pixel centers at +0.5
+    const auto x0 = std::max(
+        clip.x0, (int)std::floor(std::min({a.x, b.x, c.x}) - 0.5f));
+    const auto y0 = std::max(
+        clip.y0, (int)std::floor(std::min({a.y, b.y, c.y}) - 0.5f));
+    const auto x1 =
+        std::min(clip.x1, (int)std::ceil(std::max({a.x, b.x, c.x}) + 0.5f));
+    const auto y1 =
+        std::min(clip.y1, (int)std::ceil(std::max({a.y, b.y, c.y}) + 0.5f));
+
+    const std::array<rgba, 3> col{unpack(vtx[order[0]]->col),
+                                  unpack(vtx[order[1]]->col),
+                                  unpack(vtx[order[2]]->col)};
+    const auto bc_top_left = is_top_left(b, c);
+    const auto ca_top_left = is_top_left(c, a);
+    const auto ab_top_left = is_top_left(a, b);
+
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            const point center{x + 0.5f, y + 0.5f};
+            const auto w0 = edge(b, c, center);
+            const auto w1 = edge(c, a, center);
+            const auto w2 = edge(a, b, center);
+            if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f ||
+                (w0 == 0.0f && !bc_top_left) ||
+                (w1 == 0.0f && !ca_top_left) ||
+                (w2 == 0.0f && !ab_top_left)) {
+                continue;
+            }
+
+            const auto l0 = w0 / area;
+            const auto l1 = w1 / area;
+            const auto l2 = w2 / area;
+            rgba src{
+                col[0].r * l0 + col[1].r * l1 + col[2].r * l2,
+                col[0].g * l0 + col[1].g * l1 + col[2].g * l2,
+                col[0].b * l0 + col[1].b * l1 + col[2].b * l2,
+                col[0].a * l0 + col[1].a * l1 + col[2].a * l2,
+            };
+            if (texture) {
+                const auto u = vtx[order[0]]->uv.x * l0 +
+                               vtx[order[1]]->uv.x * l1 +
+                               vtx[order[2]]->uv.x * l2;
+                const auto v = vtx[order[0]]->uv.y * l0 +
+                               vtx[order[1]]->uv.y * l1 +
+                               vtx[order[2]]->uv.y * l2;
+                const auto t = sample(*texture, u, v);
+                src = {src.r * t.r, src.g * t.g, src.b * t.b, src.a * t.a};
+            }
+
+            const auto i = (size_t)y * target.width + x;
+            blend(target.color[i], src);
+            if (target.overdraw[i] < UINT16_MAX) {
+                target.overdraw[i]++;
+            }
+        }
+    }
+}
+
+void put_u32_be(std::vector<uint8_t> &out, uint32_t value) {
+    for (int i = 3; i >= 0; i--) {
+        out.push_back((uint8_t)(value >> (i * 8)));
+    }
+}
+
+uint32_t crc32(const uint8_t *data, size_t size, uint32_t crc = 0) {
+    static const auto table = [] {
+        std::array<uint32_t, 256> ret{};
+        for (uint32_t i = 0; i < 256; i++) {
+            auto c = i;
+            for (int k = 0; k < 8; k++) {
+                c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            ret[i] = c;
+        }
+        return ret;
+    }();
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void put_chunk(std::vector<uint8_t> &out, const char *type,
+               const std::vector<uint8_t> &data) {
+    put_u32_be(out, (uint32_t)data.size());
+    const auto start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    put_u32_be(out, crc32(out.data() + start, out.size() - start));
+}
+
+constexpr std::array<uint8_t, 8> png_signature = {0x89, 'P',  'N',  'G',
+                                                  '\r', '\n', 0x1A, '\n'};
+
+// rgba rows, zlib with stored deflate blocks
+bool write_rgba_png(const char *path, int width, int height,
+                    const std::vector<uint8_t> &rgba) {
+    std::vector<uint8_t> raw;
+    const auto stride = (size_t)width * 4;
+    for (int y = 0; y < height; y++) {
+        raw.push_back(0);
+        raw.insert(raw.end(), rgba.begin() + y * stride,
+                   rgba.begin() + (y + 1) * stride);
+    }
+
+    std::vector<uint8_t> zlib{0x78, 0x01};
+    for (size_t pos = 0; pos < raw.size() || pos == 0;) {
+        const auto size = std::min<size_t>(raw.size() - pos, 0xFFFF);
+        const auto last = pos + size == raw.size();
+        zlib.push_back(last ? 1 : 0);
+        zlib.push_back((uint8_t)size);
+        zlib.push_back((uint8_t)(size >> 8));
+        zlib.push_back((uint8_t)~size);
+        zlib.push_back((uint8_t)(~size >> 8));
+        zlib.insert(zlib.end(), raw.begin() + pos, raw.begin() + pos + size);
+        pos += size;
+        if (last) {
+            break;
+        }
+    }
+    uint32_t s1 = 1;
+    uint32_t s2 = 0;
+    for (const auto byte : raw) {
+        s1 = (s1 + byte) % 65521;
+        s2 = (s2 + s1) % 65521;
+    }
+    put_u32_be(zlib, (s2 << 16) | s1);
+
+    std::vector<uint8_t> header;
+    put_u32_be(header, (uint32_t)width);
+    put_u32_be(header, (uint32_t)height);
+    // 8 bit rgba, deflate, no filter, no interlace
+    header.insert(header.end(), {8, 6, 0, 0, 0});
+
+    std::vector<uint8_t> png{png_signature.begin(), png_signature.end()};
+    put_chunk(png, "IHDR", header);
+    put_chunk(png, "IDAT", zlib);
+    put_chunk(png, "IEND", {});
+
+    const auto file = std::fopen(path, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    const auto written = std::fwrite(png.data(), 1, png.size(), file);
+    return std::fclose(file) == 0 && written == png.size();
+}
+
+uint32_t get_u32_be(const uint8_t *p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 |
+           p[3];
+}
+} // namespace
+
+void raster::target::resize(int width, int height) {
+    this->width = width;
+    this->height = height;
+    color.resize((size_t)width * height);
+    overdraw.resize((size_t)width * height);
+}
+
+void raster::target::clear(ImU32 color) {
+    std::fill(this->color.begin(), this->color.end(), color);
+    std::fill(overdraw.begin(), overdraw.end(), 0);
+}
+
+void raster::render(const ImDrawData &data, target &target,
+                    const texture *texture) {
+    const auto offset = data.DisplayPos;
+    const auto scale = data.FramebufferScale;
+    for (int n = 0; n < data.CmdListsCount; n++) {
+        const ImDrawList *list = data.CmdLists[n];
+        for (const auto &cmd : list->CmdBuffer) {
+            if (cmd.UserCallback != nullptr || cmd.ElemCount == 0) {
+                continue;
+            }
+
+            const rect clip{
+                std::max(0, (int)((cmd.ClipRect.x - offset.x) * scale.x)),
+                std::max(0, (int)((cmd.ClipRect.y - offset.y) * scale.y)),
+                std::min(target.width,
+                         (int)((cmd.ClipRect.z - offset.x) * scale.x)),
+                std::min(target.height,
+                         (int)((cmd.ClipRect.w - offset.y) * scale.y)),
+            };
+            if (clip.x0 >= clip.x1 || clip.y0 >= clip.y1) {
+                continue;
+            }
+
+            const auto idx = list->IdxBuffer.Data + cmd.IdxOffset;
+            const auto vtx = list->VtxBuffer.Data + cmd.VtxOffset;
+            for (unsigned i = 0; i + 2 < cmd.ElemCount; i += 3) {
+                draw_triangle({&vtx[idx[i]], &vtx[idx[i + 1]],
+                               &vtx[idx[i + 2]]},
+                              offset, scale, clip, texture, target);
+            }
+        }
+    }
+}
+
+raster::metrics raster::measure(const target &target) {
+    metrics ret{};
+    for (const auto count : target.overdraw) {
+        ret.shaded += count;
+        ret.covered += count > 0;
+        ret.max_overdraw = std::max<uint32_t>(ret.max_overdraw, count);
+    }
+    if (ret.covered > 0) {
+        ret.average_overdraw = (double)ret.shaded / ret.covered;
+    }
+    return ret;
+}
+
+bool raster::write_png(const char *path, const target &target) {
+    std::vector<uint8_t> rgba(target.color.size() * 4);
+    for (size_t i = 0; i < target.color.size(); i++) {
+        for (size_t k = 0; k < 4; k++) {
+            rgba[i * 4 + k] = (uint8_t)(target.color[i] >> (k * 8));
+        }
+    }
+    return write_rgba_png(path, target.width, target.height, rgba);
+}
+
+bool raster::write_overdraw_png(const char *path, const target &target,
+                                uint32_t max_overdraw) {
+    std::vector<uint8_t> rgba(target.overdraw.size() * 4);
+    for (size_t i = 0; i < target.overdraw.size(); i++) {
+        const auto value = std::min<uint32_t>(target.overdraw[i], max_overdraw);
+        const auto level = (uint8_t)(value * 255 / std::max(1u, max_overdraw));
+        rgba[i * 4] = level;
+        rgba[i * 4 + 1] = level;
+        rgba[i * 4 + 2] = level;
+        rgba[i * 4 + 3] = 0xFF;
+    }
+    return write_rgba_png(path, target.width, target.height, rgba);
+}
+
+bool raster::read_png(const char *path, target &out) {
+    const auto file = std::fopen(path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    std::vector<uint8_t> png;
+    std::array<uint8_t, 4096> buffer;
+    size_t read = 0;
+    while ((read = std::fread(buffer.data(), 1, buffer.size(), file)) > 0) {
+        png.insert(png.end(), buffer.begin(), buffer.begin() + read);
+    }
+    std::fclose(file);
+
+    if (png.size() < png_signature.size() ||
+        !std::equal(png_signature.begin(), png_signature.end(), png.begin())) {
+        return false;
+    }
+
+    std::vector<uint8_t> zlib;
+    int width = 0;
+    int height = 0;
+    for (size_t pos = png_signature.size(); pos + 12 <= png.size();) {
+        const auto size = get_u32_be(&png[pos]);
+        if (png.size() - pos - 12 < size) {
+            return false;
+        }
+        const auto type = (const char *)&png[pos + 4];
+        const auto data = &png[pos + 8];
+        if (std::memcmp(type, "IHDR", 4) == 0) {
+            if (size != 13 || data[8] != 8 || data[9] != 6 || data[12] != 0) {
+                return false;
+            }
+            width = (int)get_u32_be(data);
+            height = (int)get_u32_be(data + 4);
+        } else if (std::memcmp(type, "IDAT", 4) == 0) {
+            zlib.insert(zlib.end(), data, data + size);
+        }
+        pos += 12 + size;
+    }
+
+    // stored blocks only
+    std::vector<uint8_t> raw;
+    for (size_t pos = 2; pos + 5 <= zlib.size();) {
+        const auto header = zlib[pos];
+        if ((header & 0x06) != 0) {
+            return false;
+        }
+        const auto size = (size_t)(zlib[pos + 1] | zlib[pos + 2] << 8);
+        pos += 5;
+        if (zlib.size() - pos < size) {
+            return false;
+        }
+        raw.insert(raw.end(), zlib.begin() + pos, zlib.begin() + pos + size);
+        pos += size;
+        if (header & 1) {
+            break;
+        }
+    }
+
+    const auto stride = (size_t)width * 4;
+    if (width <= 0 || height <= 0 || raw.size() != (stride + 1) * height) {
+        return false;
+    }
+    out.resize(width, height);
+    out.clear();
+    for (int y = 0; y < height; y++) {
+        const auto row = &raw[y * (stride + 1)];
+        if (row[0] != 0) {
+            return false;
+        }
+        for (int x = 0; x < width; x++) {
+            const auto p = row + 1 + x * 4;
+            out.color[(size_t)y * width + x] =
+                (ImU32)p[0] | (ImU32)p[1] << 8 | (ImU32)p[2] << 16 |
+                (ImU32)p[3] << 24;
+        }
+    }
+    return true;
+}
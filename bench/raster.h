@@ -0,0 +1,54 @@
+#pragma once
+
+#include "imgui.h"
+
+#include <cstdint>
+#include <vector>
+
+// software rasterizer for ImDrawData, blends like the dx12 backend and
+// counts every shaded fragment per pixel so fill cost can be measured
+// without a gpu
+namespace raster {
+struct target {
+    int width{};
+    int height{};
+    // IM_COL32 layout, r in the low byte
+    std::vector<ImU32> color;
+    // fragments shaded per pixel
+    std::vector<uint16_t> overdraw;
+
+    void resize(int width, int height);
+    void clear(ImU32 color = 0);
+};
+
+// sampled at the interpolated uv of every fragment, usually the font atlas
+struct texture {
+    const unsigned char *rgba{};
+    int width{};
+    int height{};
+};
+
+struct metrics {
+    // fragments, every pixel counted once per triangle covering it
+    uint64_t shaded{};
+    // pixels shaded at least once
+    uint64_t covered{};
+    // shaded per covered pixel
+    double average_overdraw{};
+    uint32_t max_overdraw{};
+};
+
+// blends every triangle of data into target, clip rects are respected and
+// user callbacks skipped
+void render(const ImDrawData &data, target &target,
+            const texture *texture = nullptr);
+metrics measure(const target &target);
+
+// 8 bit rgba png, stored uncompressed
+bool write_png(const char *path, const target &target);
+// overdraw as a heat map, black is 0 and white is max_overdraw or more
+bool write_overdraw_png(const char *path, const target &target,
+                        uint32_t max_overdraw);
+// reads back what write_png wrote, compressed pngs are not supported
+bool read_png(const char *path, target &out);
+} // namespace raster
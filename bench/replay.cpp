@@ -0,0 +1,483 @@
+// replays a draw stream capture through projection, tessellation and emission
+// without the game or a gpu, every frame is drawn on a fresh drawlist
+//
+// > hb_draw_replay capture.bin [--out results.json] [--repeat 3] [--raster]
+//                  [--a cache=0] [--b cache=1,segments=16,lod=0.5]
+//
+// --b turns on the a/b mode, both configurations run over the same frames.
+// a configuration is a comma separated list of cache=0|1, segments=n and
+// lod=px, segments and lod replace what the capture recorded. frame times
+// and allocations are the lowest of --repeat runs. --raster rasterizes the
+// frames of the first run on the cpu and adds their fill cost
+
+#include "imgui.h"
+
+#include "cache.h"
+#include "capture.h"
+#include "core.h"
+#include "math_types.h"
+#include "memory.h"
+#include "raster.h"
+#include "stats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+using clock_type = std::chrono::steady_clock;
+
+// read only view of a whole file
+struct mapped_file {
+    ~mapped_file() {
+#ifdef _WIN32
+        if (m_view) {
+            UnmapViewOfFile(m_view);
+        }
+        if (m_mapping) {
+            CloseHandle(m_mapping);
+        }
+        if (m_file != INVALID_HANDLE_VALUE) {
+            CloseHandle(m_file);
+        }
+#else
+        if (m_view) {
+            munmap(m_view, m_size);
+        }
+#endif
+    }
+
+    bool open(const char *path) {
+#ifdef _WIN32
+        m_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        LARGE_INTEGER size{};
+        if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &size) ||
+            size.QuadPart == 0) {
+            return false;
+        }
+        m_size = (size_t)size.QuadPart;
+        m_mapping =
+            CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!m_mapping) {
+            return false;
+        }
+        m_view = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+        const auto fd = ::open(path, O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st {};
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            close(fd);
+            return false;
+        }
+        m_size = (size_t)st.st_size;
+        m_view = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (m_view == MAP_FAILED) {
+            m_view = nullptr;
+        }
+#endif
+        return m_view != nullptr;
+    }
+
+    std::span<const uint8_t> data() const {
+        return {(const uint8_t *)m_view, m_size};
+    }
+
+  private:
+#ifdef _WIN32
+    HANDLE m_file{INVALID_HANDLE_VALUE};
+    HANDLE m_mapping{};
+#endif
+    void *m_view{};
+    size_t m_size{};
+};
+
+struct config {
+    const char *name;
+    bool cache{};
+    std::optional<unsigned> segments{};
+    std::optional<float> lod{};
+};
+
+struct frame_result {
+    uint64_t index;
+    double us;
+    uint64_t vertices;
+    uint64_t indices;
+    uint64_t allocations;
+    uint64_t allocated_bytes;
+    uint64_t cache_hits;
+    raster::metrics fill;
+};
+
+struct result {
+    config settings;
+    std::vector<frame_result> frames;
+};
+
+struct options {
+    const char *capture{};
+    const char *out{};
+    size_t repeat{1};
+    bool raster{};
+    config a{"a"};
+    std::optional<config> b{};
+};
+
+raster::texture init_imgui() {
+    memory::install_imgui();
+    ImGui::CreateContext();
+    auto &io = ImGui::GetIO();
+    io.DisplaySize = ImVec2{1920.0f, 1080.0f};
+    io.DeltaTime = 1.0f / 60.0f;
+    unsigned char *pixels{};
+    int width{};
+    int height{};
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    return {pixels, width, height};
+}
+
+bool same_camera(const matrix_projection &a, const matrix_projection &b) {
+    return a.view == b.view && a.proj == b.proj && a.origin == b.origin &&
+           a.forward == b.forward && a.up == b.up &&
+           a.screen_size == b.screen_size;
+}
+
+// one pass over the capture, times and counts are written into out by
+// position so repeats can keep the fastest. frames are only rasterized into
+// target when one is given
+bool replay(std::span<const uint8_t> data, const config &config,
+            std::vector<frame_result> &out,
+            std::optional<capture::summary> &totals, raster::target *target,
+            const raster::texture &font) {
+    capture::reader reader{};
+    if (!reader.open(data)) {
+        std::fprintf(stderr, "%s\n", reader.error);
+        return false;
+    }
+
+    cache::clear();
+    cache::set_enabled(config.cache);
+    stats::clear();
+    g_core.camera_version++;
+
+    capture::frame frame{};
+    matrix_projection camera{};
+    g_core.projection = &camera;
+    size_t i = 0;
+    while (reader.next(frame)) {
+        if (config.segments || config.lod) {
+            for (auto &style : frame.styles) {
+                style.num_segments = config.segments.value_or(
+                    style.num_segments);
+                style.lod_tolerance = config.lod.value_or(style.lod_tolerance);
+            }
+        }
+        if (!same_camera(camera, frame.camera)) {
+            camera = frame.camera;
+            g_core.camera_version++;
+            ImGui::GetIO().DisplaySize =
+                ImVec2{camera.screen_size.x, camera.screen_size.y};
+        }
+
+        ImGui::NewFrame();
+        g_core.drawlist = ImGui::GetBackgroundDrawList();
+
+        // only the draw is counted, not decoding or the imgui frame
+        memory::take();
+        const auto start = clock_type::now();
+        capture::draw(frame);
+        cache::end_frame();
+        const std::chrono::duration<double, std::micro> elapsed =
+            clock_type::now() - start;
+        const auto counts = memory::take();
+        stats::end_frame(start);
+        ImGui::Render();
+
+        const auto history = stats::get_history(0);
+        frame_result res{};
+        res.index = frame.index;
+        res.us = elapsed.count();
+        res.vertices = history->vertices;
+        res.indices = history->indices;
+        for (size_t k = 0; k < memory::subsystem_count; k++) {
+            res.allocations += counts.allocations[k];
+            res.allocated_bytes += counts.bytes[k];
+        }
+        res.cache_hits = history->cache_hits;
+        if (target) {
+            target->resize((int)camera.screen_size.x,
+                           (int)camera.screen_size.y);
+            target->clear();
+            raster::render(*ImGui::GetDrawData(), *target, &font);
+            res.fill = raster::measure(*target);
+        }
+        if (i < out.size()) {
+            out[i].us = std::min(out[i].us, res.us);
+            out[i].allocations = std::min(out[i].allocations, res.allocations);
+            out[i].allocated_bytes =
+                std::min(out[i].allocated_bytes, res.allocated_bytes);
+        } else {
+            out.push_back(res);
+        }
+        i++;
+    }
+
+    g_core.projection = nullptr;
+    if (reader.error) {
+        std::fprintf(stderr, "frame %zu: %s\n", i, reader.error);
+        return false;
+    }
+    totals = reader.totals;
+    return true;
+}
+
+// nearest rank over a sorted copy
+double percentile(const std::vector<double> &sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const auto rank = (size_t)(p / 100.0 * (double)(sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+struct summary {
+    double mean;
+    double p50;
+    double p90;
+    double p99;
+    double max;
+};
+
+summary summarize(const std::vector<frame_result> &frames) {
+    std::vector<double> times;
+    double total = 0.0;
+    for (const auto &frame : frames) {
+        times.push_back(frame.us);
+        total += frame.us;
+    }
+    std::sort(times.begin(), times.end());
+
+    summary ret{};
+    ret.mean = times.empty() ? 0.0 : total / (double)times.size();
+    ret.p50 = percentile(times, 50.0);
+    ret.p90 = percentile(times, 90.0);
+    ret.p99 = percentile(times, 99.0);
+    ret.max = times.empty() ? 0.0 : times.back();
+    return ret;
+}
+
+void write_summary(FILE *file, const summary &summary) {
+    std::fprintf(file,
+                 "{\"mean\": %.2f, \"p50\": %.2f, \"p90\": %.2f, "
+                 "\"p99\": %.2f, \"max\": %.2f}",
+                 summary.mean, summary.p50, summary.p90, summary.p99,
+                 summary.max);
+}
+
+void write_json(FILE *file, const options &options,
+                const std::optional<capture::summary> &totals,
+                const std::vector<result> &results) {
+    std::fprintf(file, "{\n  \"version\": 1,\n  \"repeat\": %zu,\n",
+                 options.repeat);
+    if (totals) {
+        std::fprintf(file,
+                     "  \"capture\": {\"frames\": %llu, \"dropped\": %llu},\n",
+                     (unsigned long long)totals->frames,
+                     (unsigned long long)totals->dropped);
+    }
+
+    std::fprintf(file, "  \"configs\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto &res = results[i];
+        const auto &config = res.settings;
+        std::fprintf(file, "    {\"name\": \"%s\", \"cache\": %s, ",
+                     config.name, config.cache ? "true" : "false");
+        if (config.segments) {
+            std::fprintf(file, "\"segments\": %u, ", *config.segments);
+        }
+        if (config.lod) {
+            std::fprintf(file, "\"lod\": %.3f, ", *config.lod);
+        }
+        std::fprintf(file, "\"us\": ");
+        write_summary(file, summarize(res.frames));
+        std::fprintf(file, ",\n     \"frames\": [\n");
+        for (size_t j = 0; j < res.frames.size(); j++) {
+            const auto &frame = res.frames[j];
+            std::fprintf(file,
+                         "      {\"frame\": %llu, \"us\": %.2f, "
+                         "\"vertices\": %llu, \"indices\": %llu, "
+                         "\"allocations\": %llu, \"allocated_bytes\": %llu, "
+                         "\"cache_hits\": %llu",
+                         (unsigned long long)frame.index, frame.us,
+                         (unsigned long long)frame.vertices,
+                         (unsigned long long)frame.indices,
+                         (unsigned long long)frame.allocations,
+                         (unsigned long long)frame.allocated_bytes,
+                         (unsigned long long)frame.cache_hits);
+            if (options.raster) {
+                std::fprintf(file,
+                             ", \"shaded\": %llu, \"average_overdraw\": %.3f, "
+                             "\"max_overdraw\": %u",
+                             (unsigned long long)frame.fill.shaded,
+                             frame.fill.average_overdraw,
+                             frame.fill.max_overdraw);
+            }
+            std::fprintf(file, "}%s\n", j + 1 < res.frames.size() ? "," : "");
+        }
+        std::fprintf(file, "    ]}%s\n", i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(file, "  ]");
+
+    // ratios of b over a, below 1 is b being faster
+    if (results.size() == 2) {
+        const auto a = summarize(results[0].frames);
+        const auto b = summarize(results[1].frames);
+        const auto ratio = [](double b, double a) {
+            return a > 0.0 ? b / a : 0.0;
+        };
+        std::fprintf(file,
+                     ",\n  \"b_over_a\": {\"mean\": %.3f, \"p50\": %.3f, "
+                     "\"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f}",
+                     ratio(b.mean, a.mean), ratio(b.p50, a.p50),
+                     ratio(b.p90, a.p90), ratio(b.p99, a.p99),
+                     ratio(b.max, a.max));
+    }
+    std::fprintf(file, "\n}\n");
+}
+
+bool parse_config(const char *arg, config &out) {
+    std::string text{arg};
+    size_t pos = 0;
+    while (pos < text.size()) {
+        auto end = text.find(',', pos);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        const auto item = text.substr(pos, end - pos);
+        pos = end + 1;
+
+        const auto eq = item.find('=');
+        if (eq == std::string::npos) {
+            return false;
+        }
+        const auto key = item.substr(0, eq);
+        const auto value = item.c_str() + eq + 1;
+        if (key == "cache") {
+            out.cache = std::atoi(value) != 0;
+        } else if (key == "segments") {
+            out.segments =
+                (unsigned)std::max((int)min_segments, std::atoi(value));
+        } else if (key == "lod") {
+            out.lod = (float)std::atof(value);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool parse_options(int argc, char **argv, options &out) {
+    bool valid = true;
+    for (int i = 1; i < argc; i++) {
+        const auto has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--out") == 0 && has_value) {
+            out.out = argv[++i];
+        } else if (std::strcmp(argv[i], "--repeat") == 0 && has_value) {
+            out.repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--raster") == 0) {
+            out.raster = true;
+        } else if (std::strcmp(argv[i], "--a") == 0 && has_value) {
+            valid = parse_config(argv[++i], out.a);
+        } else if (std::strcmp(argv[i], "--b") == 0 && has_value) {
+            valid = parse_config(argv[++i], out.b.emplace(config{"b"}));
+        } else if (argv[i][0] != '-' && out.capture == nullptr) {
+            out.capture = argv[i];
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            break;
+        }
+    }
+
+    if (!valid || out.capture == nullptr) {
+        std::fprintf(stderr,
+                     "usage: %s capture [--out file] [--repeat n] "
+                     "[--raster] [--a config] [--b config]\n",
+                     argv[0]);
+        return false;
+    }
+    return true;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    options options{};
+    if (!parse_options(argc, argv, options)) {
+        return 1;
+    }
+
+    mapped_file file{};
+    if (!file.open(options.capture)) {
+        std::fprintf(stderr, "can not map %s\n", options.capture);
+        return 1;
+    }
+    const auto font = init_imgui();
+
+    std::vector<config> configs{options.a};
+    if (options.b) {
+        configs.push_back(*options.b);
+    }
+
+    // repeats alternate the configurations so drift hits both alike
+    std::vector<result> results;
+    for (const auto &config : configs) {
+        results.push_back({config, {}});
+    }
+    std::optional<capture::summary> totals{};
+    raster::target target{};
+    for (size_t i = 0; i < options.repeat; i++) {
+        for (auto &res : results) {
+            const auto rasterize = options.raster && i == 0;
+            if (!replay(file.data(), res.settings, res.frames, totals,
+                        rasterize ? &target : nullptr, font)) {
+                return 1;
+            }
+        }
+    }
+
+    auto out = options.out ? std::fopen(options.out, "w") : stdout;
+    if (out == nullptr) {
+        std::fprintf(stderr, "can not open %s\n", options.out);
+        return 1;
+    }
+    write_json(out, options, totals, results);
+    if (out != stdout) {
+        std::fclose(out);
+    }
+
+    ImGui::DestroyContext();
+    return 0;
+}
@@ -0,0 +1,407 @@
+// cost of every shape constructor and draw::draw outside of the game, the
+// camera is a plain matrix_projection
+//
+// > hb_draw_bench [--out results.json] [--filter cylinder] [--min-ms 50]
+//
+// results are written as json, one entry per shape, op, segment count,
+// outline and camera pose. a fixed scene is then drawn for a number of
+// frames with and without the cache, the cached run has to be free of heap
+// allocations once warmed up or the bench fails
+
+#include "imgui.h"
+
+#include "cache.h"
+#include "core.h"
+#include "draw.h"
+#include "hull.h"
+#include "math_types.h"
+#include "memory.h"
+#include "projection.h"
+
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace {
+using clock_type = std::chrono::steady_clock;
+
+const Vector2f screen_size{1920.0f, 1080.0f};
+const float fov_y = glm::radians(60.0f);
+// draws between drawlist resets, keeps the buffers from growing unbounded
+constexpr size_t batch_size = 256;
+constexpr size_t warm_up_frames = 10;
+constexpr size_t steady_state_frames = 100;
+
+struct pose {
+    const char *name;
+    Vector3f eye;
+    Vector3f target;
+};
+
+struct result {
+    std::string shape;
+    std::string op;
+    unsigned segments;
+    bool outline;
+    std::string pose;
+    size_t iterations;
+    double ns_per_op;
+    double median_ns;
+    double vertices_per_op;
+};
+
+struct steady_state {
+    bool cache;
+    memory::counts counts;
+};
+
+struct options {
+    const char *out{};
+    const char *filter{};
+    double min_ms{20.0};
+};
+
+matrix_projection g_projection{};
+volatile bool g_sink{};
+
+// every shape spans y 0..1 around the origin
+std::vector<pose> get_poses() {
+    const auto half_fov_x =
+        std::atan(std::tan(fov_y * 0.5f) * screen_size.x / screen_size.y);
+    return {
+        {"front", {0.0f, 0.5f, -5.0f}, {0.0f, 0.5f, 0.0f}},
+        // caps project to a line
+        {"edge_on", {0.0f, 1.0f, -5.0f}, {0.0f, 1.0f, 0.0f}},
+        {"inside", {0.0f, 0.5f, 0.0f}, {0.0f, 0.5f, 1.0f}},
+        {"behind", {0.0f, 0.5f, -5.0f}, {0.0f, 0.5f, -10.0f}},
+        // center on the left screen edge
+        {"partial",
+         {0.0f, 0.5f, -5.0f},
+         {5.0f * std::tan(half_fov_x), 0.5f, 0.0f}},
+    };
+}
+
+void set_camera(const pose &pose) {
+    g_projection.view =
+        glm::lookAt(pose.eye, pose.target, Vector3f{0.0f, 1.0f, 0.0f});
+    g_projection.proj =
+        glm::perspective(fov_y, screen_size.x / screen_size.y, 0.1f, 1000.0f);
+    g_projection.origin = pose.eye;
+    // game cameras look down -z, forward points behind them
+    g_projection.forward = glm::normalize(pose.eye - pose.target);
+    g_projection.up = Vector3f{0.0f, 1.0f, 0.0f};
+    g_projection.screen_size = screen_size;
+    g_core.camera_version++;
+}
+
+void new_frame() {
+    ImGui::Render();
+    ImGui::NewFrame();
+    g_core.drawlist = ImGui::GetBackgroundDrawList();
+}
+
+void init_imgui() {
+    memory::install_imgui();
+    ImGui::CreateContext();
+    auto &io = ImGui::GetIO();
+    io.DisplaySize = ImVec2{screen_size.x, screen_size.y};
+    io.DeltaTime = 1.0f / 60.0f;
+    unsigned char *pixels{};
+    int width{};
+    int height{};
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    ImGui::NewFrame();
+    g_core.drawlist = ImGui::GetBackgroundDrawList();
+    g_core.projection = &g_projection;
+}
+
+// runs op in batches until min_ms, each batch starts on an empty drawlist
+result run(const options &options, const std::function<void()> &op) {
+    std::vector<double> batches;
+    size_t iterations = 0;
+    double total_ns = 0.0;
+    size_t vertices = 0;
+
+    while (total_ns < options.min_ms * 1e6 || batches.size() < 5) {
+        new_frame();
+        const auto start = clock_type::now();
+        for (size_t i = 0; i < batch_size; i++) {
+            op();
+        }
+        const std::chrono::duration<double, std::nano> elapsed =
+            clock_type::now() - start;
+
+        vertices += g_core.drawlist->VtxBuffer.Size;
+        batches.push_back(elapsed.count() / batch_size);
+        total_ns += elapsed.count();
+        iterations += batch_size;
+    }
+
+    std::nth_element(batches.begin(), batches.begin() + batches.size() / 2,
+                     batches.end());
+    result ret{};
+    ret.iterations = iterations;
+    ret.ns_per_op = total_ns / iterations;
+    ret.median_ns = batches[batches.size() / 2];
+    ret.vertices_per_op = (double)vertices / iterations;
+    return ret;
+}
+
+const Matrix3x3f &get_basis() {
+    static const Matrix3x3f basis = glm::mat3_cast(
+        glm::angleAxis(glm::radians(30.0f), Vector3f{0.0f, 1.0f, 0.0f}) *
+        glm::angleAxis(glm::radians(20.0f), Vector3f{1.0f, 0.0f, 0.0f}));
+    return basis;
+}
+
+// 64 points on a sphere of radius 0.5, about the size of a convex collider
+hull::mesh get_hull() {
+    constexpr size_t count = 64;
+    const auto golden_angle = glm::radians(180.0f) * (3.0f - std::sqrt(5.0f));
+    std::vector<Vector3f> points;
+    for (size_t i = 0; i < count; i++) {
+        const auto y = 1.0f - 2.0f * (i + 0.5f) / count;
+        const auto r = std::sqrt(1.0f - y * y);
+        const auto a = golden_angle * i;
+        points.push_back(Vector3f{r * std::cos(a), y, r * std::sin(a)} * 0.5f);
+    }
+    return *hull::build(points);
+}
+
+// constructs the shape in place, shapes keep pointers into themselves so
+// they can not be copied into a benchmark
+template <typename T, typename... Args> struct bench_shape {
+    const char *name;
+    // segments do not change the polygonal shapes
+    bool has_segments;
+    std::tuple<Args...> args;
+
+    void construct(std::optional<T> &out) const {
+        std::apply([&](const auto &...args) { out.emplace(args...); }, args);
+    }
+};
+
+template <typename T, typename... Args>
+bench_shape<T, Args...> make_shape(const char *name, bool has_segments,
+                                   Args... args) {
+    return {name, has_segments, {args...}};
+}
+
+template <typename T, typename... Args>
+void bench(const options &options, const bench_shape<T, Args...> &shape,
+           std::vector<result> &out) {
+    static constexpr std::array segment_counts{8u, 16u, 32u, 64u, 128u};
+    static constexpr ImU32 color = 0x40FFFFFF;
+    static constexpr ImU32 color_outline = 0xFFFFFFFF;
+
+    for (const auto segments : segment_counts) {
+        if (!shape.has_segments && segments != segment_counts.front()) {
+            break;
+        }
+        g_core.num_segments = segments;
+
+        for (const auto &pose : get_poses()) {
+            set_camera(pose);
+            const auto add = [&](const char *op, bool outline, result res) {
+                res.shape = shape.name;
+                res.op = op;
+                res.segments = shape.has_segments ? segments : 0;
+                res.outline = outline;
+                res.pose = pose.name;
+                out.push_back(std::move(res));
+            };
+
+            std::optional<T> instance{};
+            add("construct", false, run(options, [&] {
+                    shape.construct(instance);
+                    g_sink = instance->m_is_ok;
+                }));
+
+            shape.construct(instance);
+            for (const auto outline : {false, true}) {
+                add("draw", outline, run(options, [&] {
+                        draw::draw(*instance, color, outline, color_outline);
+                    }));
+            }
+        }
+    }
+}
+
+void draw_scene() {
+    static constexpr ImU32 color = 0x40FFFFFF;
+    static constexpr ImU32 color_outline = 0xFFFFFFFF;
+    const Vector3f start{0.0f, 0.0f, 0.0f};
+    const Vector3f end{0.0f, 1.0f, 0.0f};
+    const Vector3f center{0.0f, 0.5f, 0.0f};
+    const Vector3f extent{0.5f, 0.5f, 0.5f};
+
+    draw::draw_sphere(center, 0.5f, color, true, color_outline);
+    draw::draw_box(center, extent, get_basis(), color, true, color_outline);
+    draw::draw_triangle(center, extent, get_basis(), color, true,
+                        color_outline);
+    draw::draw_cylinder(start, end, 0.5f, color, true, color_outline);
+    draw::draw_ring(start, end, 0.3f, 0.5f, color, true, color_outline);
+    draw::draw_capsule(start, end, 0.3f, color, true, color_outline);
+}
+
+// allocations of steady_state_frames frames of the same scene and camera
+steady_state run_steady_state(bool cache) {
+    cache::clear();
+    cache::set_enabled(cache);
+    g_core.num_segments = 32;
+    set_camera(get_poses().front());
+
+    for (size_t i = 0; i < warm_up_frames; i++) {
+        new_frame();
+        draw_scene();
+        cache::end_frame();
+    }
+    memory::take();
+    for (size_t i = 0; i < steady_state_frames; i++) {
+        new_frame();
+        draw_scene();
+        cache::end_frame();
+    }
+    return {cache, memory::take()};
+}
+
+uint64_t get_total(const memory::counts &counts) {
+    uint64_t ret = 0;
+    for (const auto allocations : counts.allocations) {
+        ret += allocations;
+    }
+    return ret;
+}
+
+void write_counts(FILE *file, const char *name,
+                  const std::array<uint64_t, memory::subsystem_count> &values) {
+    std::fprintf(file,
+                 "\"%s\": {\"other\": %llu, \"construct\": %llu, "
+                 "\"drawlist\": %llu, \"binding\": %llu}",
+                 name, (unsigned long long)values[0],
+                 (unsigned long long)values[1], (unsigned long long)values[2],
+                 (unsigned long long)values[3]);
+}
+
+void write_json(FILE *file, const std::vector<result> &results,
+                const std::vector<steady_state> &steady_states) {
+    std::fprintf(file, "{\n  \"version\": 1,\n  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto &res = results[i];
+        std::fprintf(
+            file,
+            "    {\"shape\": \"%s\", \"op\": \"%s\", \"segments\": %u, "
+            "\"outline\": %s, \"pose\": \"%s\", \"iterations\": %zu, "
+            "\"ns_per_op\": %.2f, \"median_ns\": %.2f, "
+            "\"vertices_per_op\": %.2f}%s\n",
+            res.shape.c_str(), res.op.c_str(), res.segments,
+            res.outline ? "true" : "false", res.pose.c_str(), res.iterations,
+            res.ns_per_op, res.median_ns, res.vertices_per_op,
+            i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(file, "  ],\n  \"steady_state\": [\n");
+    for (size_t i = 0; i < steady_states.size(); i++) {
+        const auto &state = steady_states[i];
+        std::fprintf(file, "    {\"cache\": %s, \"frames\": %zu, ",
+                     state.cache ? "true" : "false", steady_state_frames);
+        write_counts(file, "allocations", state.counts.allocations);
+        std::fprintf(file, ", ");
+        write_counts(file, "bytes", state.counts.bytes);
+        std::fprintf(file, "}%s\n", i + 1 < steady_states.size() ? "," : "");
+    }
+    std::fprintf(file, "  ]\n}\n");
+}
+
+bool parse_options(int argc, char **argv, options &out) {
+    for (int i = 1; i < argc; i++) {
+        const auto has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--out") == 0 && has_value) {
+            out.out = argv[++i];
+        } else if (std::strcmp(argv[i], "--filter") == 0 && has_value) {
+            out.filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--min-ms") == 0 && has_value) {
+            out.min_ms = std::atof(argv[++i]);
+        } else {
+            std::fprintf(stderr,
+                         "usage: %s [--out file] [--filter shape] "
+                         "[--min-ms ms]\n",
+                         argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    options options{};
+    if (!parse_options(argc, argv, options)) {
+        return 1;
+    }
+    init_imgui();
+
+    const Vector3f start{0.0f, 0.0f, 0.0f};
+    const Vector3f end{0.0f, 1.0f, 0.0f};
+    const Vector3f center{0.0f, 0.5f, 0.0f};
+    const Vector3f extent{0.5f, 0.5f, 0.5f};
+
+    std::vector<result> results;
+    const auto matches = [&](const char *name) {
+        return options.filter == nullptr ||
+               std::strstr(name, options.filter) != nullptr;
+    };
+    const auto add = [&](const auto &shape) {
+        if (matches(shape.name)) {
+            bench(options, shape, results);
+        }
+    };
+
+    add(make_shape<Sphere>("sphere", true, center, 0.5f));
+    add(make_shape<Box>("box", false, center, extent, get_basis()));
+    add(make_shape<Triangle>("triangle", false, center, extent, get_basis()));
+    add(make_shape<Cylinder>("cylinder", true, start, end, 0.5f));
+    add(make_shape<Ring>("ring", true, start, end, 0.3f, 0.5f));
+    add(make_shape<Capsule>("capsule", true, start, end, 0.3f));
+    add(make_shape<Ellipsoid>("ellipsoid", true, center,
+                              Vector3f{0.5f, 0.3f, 0.2f}, get_basis()));
+    add(make_shape<Cylinder>("cone", true, start, end, 0.5f, 0.0f, 0.0f, false,
+                             0u));
+    add(make_shape<Hull>("hull", false, get_hull(), center, get_basis()));
+
+    const std::vector<steady_state> steady_states{run_steady_state(false),
+                                                  run_steady_state(true)};
+
+    auto file = options.out ? std::fopen(options.out, "w") : stdout;
+    if (file == nullptr) {
+        std::fprintf(stderr, "can not open %s\n", options.out);
+        return 1;
+    }
+    write_json(file, results, steady_states);
+    if (file != stdout) {
+        std::fclose(file);
+    }
+
+    ImGui::DestroyContext();
+
+    const auto cached = get_total(steady_states.back().counts);
+    if (cached > 0) {
+        std::fprintf(stderr,
+                     "%llu allocations in %zu cached steady state frames\n",
+                     (unsigned long long)cached, steady_state_frames);
+        return 1;
+    }
+    return 0;
+}
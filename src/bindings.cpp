@@ -0,0 +1,262 @@
+#include <sol/sol.hpp>
+
+#include "bindings.h"
+#include "cache.h"
+#include "capture.h"
+#include "display_list.h"
+#include "memory.h"
+#include "plugin.h"
+#include "profiler.h"
+#include "stats.h"
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <tuple>
+
+#include <windows.h>
+
+namespace {
+// files named by scripts live under reframework/data next to the game exe,
+// the same directory lua io is limited to. empty for absolute paths and
+// paths that leave it
+std::filesystem::path to_data_path(const std::string &path) {
+    const std::filesystem::path relative{
+        std::u8string{path.begin(), path.end()}};
+    if (relative.empty() || relative.has_root_path() ||
+        !relative.has_filename()) {
+        return {};
+    }
+    for (const auto &part : relative) {
+        if (part == "..") {
+            return {};
+        }
+    }
+
+    static const auto data_dir = [] {
+        std::wstring exe(MAX_PATH, L'\0');
+        DWORD size{};
+        while ((size = GetModuleFileNameW(nullptr, exe.data(),
+                                          (DWORD)exe.size())) == exe.size()) {
+            exe.resize(exe.size() * 2);
+        }
+        exe.resize(size);
+        return std::filesystem::path{exe}.parent_path() / "reframework" /
+               "data";
+    }();
+
+    auto ret = data_dir / relative;
+    std::error_code ec;
+    std::filesystem::create_directories(ret.parent_path(), ec);
+    return ret;
+}
+
+sol::table to_table(sol::state_view &lua, const stats::script &script) {
+    auto table = lua.create_table();
+    table["submitted"] = script.last.submitted;
+    table["culled"] = script.last.culled;
+    table["drawn"] = script.last.drawn;
+    table["dropped"] = script.last.dropped;
+    table["vertices"] = script.last.vertices;
+    table["us"] = script.last.us;
+    table["budget"] = script.budget;
+    table["priority"] = script.priority;
+    return table;
+}
+
+// keyed by memory::subsystem
+template <typename T>
+sol::table to_table(sol::state_view &lua,
+                    const std::array<T, memory::subsystem_count> &values) {
+    static constexpr std::array names{"other", "construct", "drawlist",
+                                      "binding"};
+    static_assert(names.size() == memory::subsystem_count);
+
+    auto table = lua.create_table();
+    for (size_t i = 0; i < names.size(); i++) {
+        table[names[i]] = values[i];
+    }
+    return table;
+}
+
+sol::table to_table(sol::state_view &lua, const stats::frame &frame) {
+    static constexpr std::array names{
+        "sphere",  "box",       "triangle", "cylinder", "ring",
+        "capsule", "ellipsoid", "cone",     "hull",     "trail",
+        "lines",   "labels"};
+    static_assert(names.size() == std::tuple_size_v<decltype(frame.shapes)>);
+
+    auto shapes = lua.create_table();
+    for (size_t i = 0; i < names.size(); i++) {
+        shapes[names[i]] = frame.shapes[i];
+    }
+
+    auto table = lua.create_table();
+    table["shapes"] = shapes;
+    table["culled"] = frame.culled;
+    table["replayed"] = frame.replayed;
+    table["projections"] = frame.projections;
+    table["managed_calls"] = frame.managed_calls;
+    table["vertices"] = frame.vertices;
+    table["indices"] = frame.indices;
+    table["cache_hits"] = frame.cache_hits;
+    table["cache_misses"] = frame.cache_misses;
+    table["cache_entries"] = frame.cache_entries;
+    table["allocations"] = to_table(lua, frame.allocations);
+    table["allocated_bytes"] = to_table(lua, frame.allocated_bytes);
+    table["camera_us"] = frame.camera_us;
+    table["construct_us"] = frame.construct_us;
+    table["emit_us"] = frame.emit_us;
+    table["render_us"] = frame.render_us;
+    return table;
+}
+
+void bind_stats(sol::table &hb_draw) {
+    hb_draw["get_stats"] = [](sol::this_state s) {
+        std::lock_guard _{g_hbdraw.mutex};
+        sol::state_view lua{s};
+        auto table = lua.create_table();
+        for (const auto &[name, script] : stats::get_scripts()) {
+            table[name] = to_table(lua, *script);
+        }
+        return table;
+    };
+    // newest first, n defaults to 1
+    hb_draw["frame_stats"] = [](sol::this_state s, sol::optional<size_t> n) {
+        std::lock_guard _{g_hbdraw.mutex};
+        sol::state_view lua{s};
+        auto table = lua.create_table();
+        const auto count = n.value_or(1);
+        for (size_t i = 0; i < count; i++) {
+            const auto frame = stats::get_history(i);
+            if (!frame) {
+                break;
+            }
+            table[i + 1] = to_table(lua, *frame);
+        }
+        return table;
+    };
+    // script defaults to the caller
+    hb_draw["set_budget"] = [](sol::this_state s, uint64_t max_shapes,
+                               sol::optional<std::string> script_name) {
+        std::lock_guard _{g_hbdraw.mutex};
+        const auto script = script_name ? stats::get_script(*script_name)
+                                        : bindings::get_caller(s);
+        if (script) {
+            script->budget = max_shapes;
+            script->cutoff = INT_MIN;
+        }
+    };
+    // higher priorities are kept first when over budget
+    hb_draw["set_priority"] = [](sol::this_state s, int priority) {
+        std::lock_guard _{g_hbdraw.mutex};
+        if (const auto script = bindings::get_caller(s)) {
+            script->priority = priority;
+        }
+    };
+}
+
+void bind_cache(sol::table &hb_draw) {
+    // max_age is in frames, entries unused for longer are evicted
+    hb_draw["set_cache"] = [](bool enabled, sol::optional<uint64_t> max_age) {
+        std::lock_guard _{g_hbdraw.mutex};
+        cache::set_enabled(enabled);
+        if (max_age) {
+            cache::set_max_age(*max_age);
+        }
+    };
+}
+
+void bind_display_list(sol::state_view &lua, sol::table &hb_draw) {
+    using display_list::list;
+    lua.new_usertype<list>(
+        "hb_draw_list", sol::no_constructor, "get_count",
+        [](const list &self) { return self.types.size(); });
+
+    // primitives called until end_list are recorded instead of drawn, a list
+    // has to be finished in the same frame. lines, arrows, axes and labels
+    // are not recorded and skipped in between
+    hb_draw["begin_list"] = [] {
+        std::lock_guard _{g_hbdraw.mutex};
+        display_list::begin();
+    };
+    hb_draw["end_list"] = [] {
+        std::lock_guard _{g_hbdraw.mutex};
+        return display_list::end();
+    };
+    hb_draw["draw_list"] = [](sol::this_state s, const list &list,
+                              sol::optional<Matrix4x4f> transform) {
+        std::lock_guard _{g_hbdraw.mutex};
+        // drawn into the recording list when called between begin/end_list
+        if (!display_list::is_recording() && !begin_frame()) {
+            return;
+        }
+        stats::scope scope{bindings::get_caller(s)};
+        display_list::draw_list(list, transform.value_or(Matrix4x4f{1.0f}));
+    };
+}
+
+void bind_capture(sol::table &hb_draw) {
+    // path is relative to reframework/data
+    hb_draw["start_capture"] = [](const std::string &path) {
+        const auto file = to_data_path(path);
+        if (file.empty()) {
+            return false;
+        }
+        std::lock_guard _{g_hbdraw.mutex};
+        return capture::start(file.string().c_str());
+    };
+    // nil when not capturing
+    hb_draw["stop_capture"] = [](sol::this_state s) -> sol::object {
+        std::lock_guard _{g_hbdraw.mutex};
+        const auto summary = capture::stop();
+        if (!summary) {
+            return sol::nil;
+        }
+        sol::state_view lua{s};
+        auto table = lua.create_table();
+        table["frames"] = summary->frames;
+        table["dropped"] = summary->dropped;
+        table["complete"] = summary->complete;
+        return table;
+    };
+}
+
+void bind_profiler(sol::table &hb_draw) {
+    // zones only exist in builds with HB_DRAW_PROFILE, frames defaults to 120.
+    // path is relative to reframework/data
+    hb_draw["dump_trace"] = [](const std::string &path,
+                               sol::optional<size_t> frames) {
+        const auto file = to_data_path(path);
+        if (file.empty()) {
+            return false;
+        }
+        std::lock_guard _{g_hbdraw.mutex};
+        return profiler::dump_trace(file.string().c_str(),
+                                    frames.value_or(120));
+    };
+}
+} // namespace
+
+stats::script *bindings::get_caller(lua_State *l) {
+    lua_Debug ar{};
+    for (int level = 1; lua_getstack(l, level, &ar); level++) {
+        if (!lua_getinfo(l, "S", &ar) || ar.what == nullptr ||
+            ar.what[0] == 'C') {
+            continue;
+        }
+        return stats::get_script(ar.source);
+    }
+    return nullptr;
+}
+
+void bindings::bind(sol::state_view &lua, sol::table &hb_draw) {
+    bind_stats(hb_draw);
+    bind_cache(hb_draw);
+    bind_display_list(lua, hb_draw);
+    bind_capture(hb_draw);
+    bind_profiler(hb_draw);
+}
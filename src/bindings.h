@@ -0,0 +1,13 @@
+#pragma once
+
+#include <sol/sol.hpp>
+
+#include "stats.h"
+
+// lua side of the core modules, which know nothing about lua
+namespace bindings {
+// script owning the innermost non c function on the lua stack
+stats::script *get_caller(lua_State *l);
+// stats, cache, display lists, captures and the profiler
+void bind(sol::state_view &lua, sol::table &hb_draw);
+} // namespace bindings
@@ -0,0 +1,84 @@
+#include <sol/sol.hpp>
+
+#include "buffer.h"
+#include "bulk.h"
+#include "draw.h"
+#include "plugin.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+namespace {
+std::optional<draw::shape_type> to_shape_type(std::string_view kind) {
+    if (kind == "sphere") {
+        return draw::shape_type::sphere;
+    }
+    if (kind == "box") {
+        return draw::shape_type::box;
+    }
+    if (kind == "triangle") {
+        return draw::shape_type::triangle;
+    }
+    if (kind == "cylinder") {
+        return draw::shape_type::cylinder;
+    }
+    if (kind == "ring") {
+        return draw::shape_type::ring;
+    }
+    if (kind == "capsule") {
+        return draw::shape_type::capsule;
+    }
+    if (kind == "ellipsoid") {
+        return draw::shape_type::ellipsoid;
+    }
+    if (kind == "cone") {
+        return draw::shape_type::cone;
+    }
+    return std::nullopt;
+}
+} // namespace
+
+buffer::float_buffer::float_buffer(draw::shape_type type, size_t capacity)
+    : type(type), capacity(capacity), record_size(draw::record_size(type)) {
+    const auto size = std::max<size_t>(capacity * record_size, 1);
+    data.reset(static_cast<float *>(::operator new[](
+        size * sizeof(float), std::align_val_t{alignment})));
+    std::memset(data.get(), 0, size * sizeof(float));
+}
+
+void buffer::draw_buffer(const float_buffer &buffer, size_t count) {
+    count = std::min(count, buffer.capacity);
+    for (size_t i = 0; i < count; i++) {
+        draw::draw_record(buffer.type, buffer.record(i));
+    }
+}
+
+void buffer::bind(sol::state_view &lua, sol::table &hb_draw) {
+    lua.new_usertype<float_buffer>(
+        "hb_draw_buffer", sol::no_constructor,
+        // buf:set(i, ...) takes the per-call arguments or the flat numbers
+        "set",
+        [](float_buffer &self, size_t i, sol::variadic_args args) {
+            if (i < 1 || i > self.capacity) {
+                return;
+            }
+            bulk::read_args(args.lua_state(), args.stack_index(), self.type,
+                            self.record(i - 1));
+        },
+        "get_capacity", [](const float_buffer &self) { return self.capacity; },
+        "get_record_size",
+        [](const float_buffer &self) { return self.record_size; });
+
+    hb_draw["new_buffer"] =
+        [](std::string_view kind,
+           size_t capacity) -> std::shared_ptr<float_buffer> {
+        const auto type = to_shape_type(kind);
+        if (!type) {
+            return nullptr;
+        }
+        return std::make_shared<float_buffer>(*type, capacity);
+    };
+}
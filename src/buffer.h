@@ -0,0 +1,34 @@
+#pragma once
+
+#include <sol/sol.hpp>
+
+#include "draw.h"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+namespace buffer {
+constexpr size_t alignment = 16;
+
+struct aligned_delete {
+    void operator()(float *ptr) const {
+        ::operator delete[](ptr, std::align_val_t{alignment});
+    }
+};
+
+// capacity records of draw::draw_record layout laid out back to back
+struct float_buffer {
+    float_buffer(draw::shape_type type, size_t capacity);
+
+    float *record(size_t i) const { return data.get() + i * record_size; }
+
+    draw::shape_type type;
+    size_t capacity;
+    size_t record_size;
+    std::unique_ptr<float[], aligned_delete> data;
+};
+
+void draw_buffer(const float_buffer &buffer, size_t count);
+void bind(sol::state_view &lua, sol::table &hb_draw);
+} // namespace buffer
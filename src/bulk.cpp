@@ -0,0 +1,349 @@
+#include "imgui.h"
+#include "reframework/Math.hpp"
+#include <sol/sol.hpp>
+
+#include "bulk.h"
+#include "draw.h"
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+using draw::shape_type;
+
+float to_color(lua_State *l, int idx) {
+    return std::bit_cast<float>((ImU32)lua_tointeger(l, idx));
+}
+
+float to_bool(lua_State *l, int idx) {
+    if (lua_isboolean(l, idx)) {
+        return lua_toboolean(l, idx) ? 1.0f : 0.0f;
+    }
+    return lua_tonumber(l, idx) != 0.0 ? 1.0f : 0.0f;
+}
+
+// push(n) pushes the n-th value (1 based) of the source onto the stack, the
+// readers pop it again
+
+template <typename Push>
+void read_style(lua_State *l, Push &push, int first, float *out) {
+    push(first);
+    out[0] = to_color(l, -1);
+    push(first + 1);
+    out[1] = to_bool(l, -1);
+    push(first + 2);
+    out[2] = to_color(l, -1);
+    lua_pop(l, 3);
+}
+
+template <typename T, typename Push>
+void read_usertype(lua_State *l, Push &push, int n, float *out) {
+    push(n);
+    if (sol::stack::check<T>(l, -1, sol::no_panic)) {
+        const auto &v = sol::stack::get<const T &>(l, -1);
+        std::memcpy(out, &v, sizeof(T));
+    } else {
+        std::memset(out, 0, sizeof(T));
+    }
+    lua_pop(l, 1);
+}
+
+template <typename Push>
+void read_number(lua_State *l, Push &push, int n, float *out) {
+    push(n);
+    *out = (float)lua_tonumber(l, -1);
+    lua_pop(l, 1);
+}
+
+// same argument order as the per-call api
+template <typename Push>
+void read_record(lua_State *l, shape_type type, Push push, float *out) {
+    switch (type) {
+    case shape_type::sphere:
+        read_usertype<Vector3f>(l, push, 1, out);
+        read_number(l, push, 2, out + 3);
+        read_style(l, push, 3, out + 4);
+        break;
+    case shape_type::box:
+    case shape_type::triangle:
+    case shape_type::ellipsoid:
+        read_usertype<Vector3f>(l, push, 1, out);
+        read_usertype<Vector3f>(l, push, 2, out + 3);
+        read_usertype<Matrix4x4f>(l, push, 3, out + 6);
+        read_style(l, push, 4, out + 22);
+        break;
+    case shape_type::cylinder:
+    case shape_type::capsule:
+        read_usertype<Vector3f>(l, push, 1, out);
+        read_usertype<Vector3f>(l, push, 2, out + 3);
+        read_number(l, push, 3, out + 6);
+        read_style(l, push, 4, out + 7);
+        break;
+    case shape_type::ring:
+    case shape_type::cone:
+        read_usertype<Vector3f>(l, push, 1, out);
+        read_usertype<Vector3f>(l, push, 2, out + 3);
+        read_number(l, push, 3, out + 6);
+        read_number(l, push, 4, out + 7);
+        read_style(l, push, 5, out + 8);
+        break;
+    case shape_type::hull:
+    case shape_type::trail:
+    case shape_type::lines:
+    case shape_type::labels:
+        break;
+    }
+}
+
+template <typename Push>
+void read_flat(lua_State *l, size_t size, Push push, float *out) {
+    for (size_t i = 0; i < size; i++) {
+        push((int)i + 1);
+        if (i == size - 3 || i == size - 1) {
+            out[i] = to_color(l, -1);
+        } else if (i == size - 2) {
+            out[i] = to_bool(l, -1);
+        } else {
+            out[i] = (float)lua_tonumber(l, -1);
+        }
+        lua_pop(l, 1);
+    }
+}
+
+void draw_list(const sol::table &list, shape_type type) {
+    const auto l = list.lua_state();
+    const auto size = draw::record_size(type);
+    std::array<float, draw::max_record_size> record;
+
+    list.push();
+    const int table = lua_gettop(l);
+    const auto len = (lua_Integer)lua_rawlen(l, table);
+
+    lua_rawgeti(l, table, 1);
+    const bool is_flat = lua_type(l, -1) == LUA_TNUMBER;
+    lua_pop(l, 1);
+
+    if (is_flat) {
+        for (lua_Integer i = 1; i + (lua_Integer)size - 1 <= len; i += size) {
+            read_flat(
+                l, size, [&](int n) { lua_rawgeti(l, table, i + n - 1); },
+                record.data());
+            draw::draw_record(type, record.data());
+        }
+    } else {
+        for (lua_Integer i = 1; i <= len; i++) {
+            if (lua_rawgeti(l, table, i) == LUA_TTABLE) {
+                const int t = lua_gettop(l);
+                read_record(
+                    l, type, [&](int n) { lua_rawgeti(l, t, n); },
+                    record.data());
+                draw::draw_record(type, record.data());
+            }
+            lua_pop(l, 1);
+        }
+    }
+    lua_pop(l, 1);
+}
+
+std::span<const Vector3f> read_positions(const sol::table &positions) {
+    static std::vector<Vector3f> ret;
+    ret.clear();
+
+    const auto l = positions.lua_state();
+    positions.push();
+    const int table = lua_gettop(l);
+    const auto len = (lua_Integer)lua_rawlen(l, table);
+
+    lua_rawgeti(l, table, 1);
+    const bool is_flat = lua_type(l, -1) == LUA_TNUMBER;
+    lua_pop(l, 1);
+
+    auto push = [&](int n) { lua_rawgeti(l, table, n); };
+    if (is_flat) {
+        for (lua_Integer i = 1; i + 2 <= len; i += 3) {
+            Vector3f &pos = ret.emplace_back();
+            for (int c = 0; c < 3; c++) {
+                read_number(l, push, (int)i + c, &pos[c]);
+            }
+        }
+    } else {
+        for (lua_Integer i = 1; i <= len; i++) {
+            read_usertype<Vector3f>(l, push, (int)i, &ret.emplace_back()[0]);
+        }
+    }
+    lua_pop(l, 1);
+    return ret;
+}
+
+std::span<const ImU32> read_colors(const sol::object &colors) {
+    static std::vector<ImU32> ret;
+    ret.clear();
+    if (colors.get_type() == sol::type::number) {
+        ret.push_back(colors.as<ImU32>());
+        return ret;
+    }
+    if (colors.get_type() != sol::type::table) {
+        return ret;
+    }
+
+    const auto l = colors.lua_state();
+    colors.push();
+    const int table = lua_gettop(l);
+    const auto len = (lua_Integer)lua_rawlen(l, table);
+    ret.reserve(len);
+    for (lua_Integer i = 1; i <= len; i++) {
+        lua_rawgeti(l, table, i);
+        ret.push_back((ImU32)lua_tointeger(l, -1));
+        lua_pop(l, 1);
+    }
+    lua_pop(l, 1);
+    return ret;
+}
+
+// numbers are formatted like tostring, anything else comes out empty. the
+// texts are copied since converted numbers do not outlive the stack slot
+std::span<const std::string_view> read_strings(const sol::table &strings) {
+    static std::string text;
+    static std::vector<size_t> ends;
+    static std::vector<std::string_view> ret;
+    text.clear();
+    ends.clear();
+    ret.clear();
+
+    const auto l = strings.lua_state();
+    strings.push();
+    const int table = lua_gettop(l);
+    const auto len = (lua_Integer)lua_rawlen(l, table);
+    for (lua_Integer i = 1; i <= len; i++) {
+        lua_rawgeti(l, table, i);
+        size_t size = 0;
+        const auto str = lua_type(l, -1) == LUA_TSTRING ||
+                                 lua_type(l, -1) == LUA_TNUMBER
+                             ? lua_tolstring(l, -1, &size)
+                             : nullptr;
+        text.append(str ? str : "", size);
+        ends.push_back(text.size());
+        lua_pop(l, 1);
+    }
+    lua_pop(l, 1);
+
+    // views are taken once text is done growing
+    size_t start = 0;
+    for (const auto end : ends) {
+        ret.emplace_back(text.data() + start, end - start);
+        start = end;
+    }
+    return ret;
+}
+} // namespace
+
+void bulk::read_args(lua_State *l, int first, shape_type type, float *out) {
+    auto push = [&](int n) { lua_pushvalue(l, first + n - 1); };
+    if (lua_type(l, first) == LUA_TNUMBER) {
+        read_flat(l, draw::record_size(type), push, out);
+    } else {
+        read_record(l, type, push, out);
+    }
+}
+
+void bulk::draw_spheres(const sol::table &list) {
+    draw_list(list, shape_type::sphere);
+}
+
+void bulk::draw_boxes(const sol::table &list) {
+    draw_list(list, shape_type::box);
+}
+
+void bulk::draw_triangles(const sol::table &list) {
+    draw_list(list, shape_type::triangle);
+}
+
+void bulk::draw_cylinders(const sol::table &list) {
+    draw_list(list, shape_type::cylinder);
+}
+
+void bulk::draw_rings(const sol::table &list) {
+    draw_list(list, shape_type::ring);
+}
+
+void bulk::draw_capsules(const sol::table &list) {
+    draw_list(list, shape_type::capsule);
+}
+
+void bulk::draw_ellipsoids(const sol::table &list) {
+    draw_list(list, shape_type::ellipsoid);
+}
+
+void bulk::draw_cones(const sol::table &list) {
+    draw_list(list, shape_type::cone);
+}
+
+void bulk::draw_sphere_instances(float radius, const sol::table &positions,
+                                 ImU32 color, bool outline,
+                                 ImU32 color_outline) {
+    draw::draw_sphere_instances(radius, read_positions(positions), color,
+                                outline, color_outline);
+}
+
+void bulk::draw_box_instances(const Vector3f &extent, const Matrix4x4f &rot,
+                              const sol::table &positions, ImU32 color,
+                              bool outline, ImU32 color_outline) {
+    draw::draw_box_instances(extent, Matrix3x3f(rot),
+                             read_positions(positions), color, outline,
+                             color_outline);
+}
+
+void bulk::draw_box_instances(const Vector3f &extent, const glm::quat &rot,
+                              const sol::table &positions, ImU32 color,
+                              bool outline, ImU32 color_outline) {
+    draw::draw_box_instances(extent, glm::mat3_cast(rot),
+                             read_positions(positions), color, outline,
+                             color_outline);
+}
+
+void bulk::draw_triangle_instances(const Vector3f &extent,
+                                   const Matrix4x4f &rot,
+                                   const sol::table &positions, ImU32 color,
+                                   bool outline, ImU32 color_outline) {
+    draw::draw_triangle_instances(extent, Matrix3x3f(rot),
+                                  read_positions(positions), color, outline,
+                                  color_outline);
+}
+
+void bulk::draw_triangle_instances(const Vector3f &extent,
+                                   const glm::quat &rot,
+                                   const sol::table &positions, ImU32 color,
+                                   bool outline, ImU32 color_outline) {
+    draw::draw_triangle_instances(extent, glm::mat3_cast(rot),
+                                  read_positions(positions), color, outline,
+                                  color_outline);
+}
+
+void bulk::draw_lines(const sol::table &points, const sol::object &colors) {
+    draw::draw_lines(read_positions(points), read_colors(colors));
+}
+
+void bulk::draw_arrows(const sol::table &points, const sol::object &colors,
+                       sol::optional<float> head_size) {
+    draw::draw_arrows(read_positions(points), read_colors(colors),
+                      head_size.value_or(0.0f));
+}
+
+void bulk::draw_labels(const sol::table &positions, const sol::table &strings,
+                       const sol::object &colors, sol::optional<float> size) {
+    draw::draw_labels(read_positions(positions), read_strings(strings),
+                      read_colors(colors), size.value_or(0.0f));
+}
+
+void bulk::draw_axes(const Vector3f &pos, const Matrix4x4f &rot, float size) {
+    draw::draw_axes(pos, Matrix3x3f(rot), size);
+}
+
+void bulk::draw_axes(const Vector3f &pos, const glm::quat &rot, float size) {
+    draw::draw_axes(pos, glm::mat3_cast(rot), size);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "imgui.h"
+#include "reframework/Math.hpp"
+#include <sol/sol.hpp>
+
+#include "draw.h"
+
+namespace bulk {
+// reads one draw::draw_record from the lua stack starting at first, either
+// the per-call arguments or the flat numbers
+void read_args(lua_State *l, int first, draw::shape_type type, float *out);
+
+// list is either an array of records holding the per-call arguments or a
+// flat number array of draw::draw_record layouts
+void draw_spheres(const sol::table &list);
+void draw_boxes(const sol::table &list);
+void draw_triangles(const sol::table &list);
+void draw_cylinders(const sol::table &list);
+void draw_rings(const sol::table &list);
+void draw_capsules(const sol::table &list);
+void draw_ellipsoids(const sol::table &list);
+void draw_cones(const sol::table &list);
+
+// positions is either an array of Vector3f or a flat x, y, z number array
+void draw_sphere_instances(float radius, const sol::table &positions,
+                           ImU32 color, bool outline, ImU32 color_outline);
+void draw_box_instances(const Vector3f &extent, const Matrix4x4f &rot,
+                        const sol::table &positions, ImU32 color, bool outline,
+                        ImU32 color_outline);
+void draw_box_instances(const Vector3f &extent, const glm::quat &rot,
+                        const sol::table &positions, ImU32 color, bool outline,
+                        ImU32 color_outline);
+void draw_triangle_instances(const Vector3f &extent, const Matrix4x4f &rot,
+                             const sol::table &positions, ImU32 color,
+                             bool outline, ImU32 color_outline);
+void draw_triangle_instances(const Vector3f &extent, const glm::quat &rot,
+                             const sol::table &positions, ImU32 color,
+                             bool outline, ImU32 color_outline);
+
+// points as above, two per segment. colors is one integer for all segments
+// or an array with one per segment
+void draw_lines(const sol::table &points, const sol::object &colors);
+void draw_arrows(const sol::table &points, const sol::object &colors,
+                 sol::optional<float> head_size);
+// strings hold one text or number per position
+void draw_labels(const sol::table &positions, const sol::table &strings,
+                 const sol::object &colors, sol::optional<float> size);
+void draw_axes(const Vector3f &pos, const Matrix4x4f &rot, float size);
+void draw_axes(const Vector3f &pos, const glm::quat &rot, float size);
+} // namespace bulk
@@ -0,0 +1,103 @@
+#include "cache.h"
+#include "core.h"
+#include "draw.h"
+#include "stats.h"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+// record followed by the draw state that changes tessellation, as raw bits.
+// colors are bit cast into the record and would compare as nan as floats
+constexpr size_t key_size = draw::max_record_size + 3;
+using cache_key = std::array<uint32_t, key_size>;
+
+struct entry {
+    draw::shape_type type;
+    cache_key key;
+    // entries of an older camera are refilled in place on the next miss
+    uint64_t camera_version;
+    uint64_t last_used;
+    draw::util::mesh mesh;
+};
+
+std::unordered_map<uint64_t, entry> g_entries;
+bool g_enabled{false};
+uint64_t g_max_age{60};
+uint64_t g_frame{};
+
+cache_key make_key(draw::shape_type type, const float *record) {
+    cache_key ret{};
+    const auto size = draw::record_size(type);
+    std::memcpy(ret.data(), record, sizeof(float) * size);
+    ret[size] = g_core.num_segments;
+    ret[size + 1] = std::bit_cast<uint32_t>(g_core.outline_tickness);
+    ret[size + 2] = std::bit_cast<uint32_t>(g_core.lod_tolerance);
+    return ret;
+}
+
+// fnv-1a over the key bytes
+uint64_t hash(draw::shape_type type, const cache_key &key) {
+    uint64_t ret = 14695981039346656037ull ^ (uint64_t)type;
+    const auto bytes = (const unsigned char *)key.data();
+    for (size_t i = 0; i < sizeof(uint32_t) * key.size(); i++) {
+        ret = (ret ^ bytes[i]) * 1099511628211ull;
+    }
+    return ret;
+}
+} // namespace
+
+bool cache::is_enabled() { return g_enabled; }
+
+const draw::util::mesh *cache::find(draw::shape_type type,
+                                    const float *record) {
+    const auto key = make_key(type, record);
+    const auto it = g_entries.find(hash(type, key));
+    if (it == g_entries.end() || it->second.type != type ||
+        it->second.key != key ||
+        it->second.camera_version != g_core.camera_version) {
+        stats::g_frame.cache_misses++;
+        return nullptr;
+    }
+
+    stats::g_frame.cache_hits++;
+    it->second.last_used = g_frame;
+    return &it->second.mesh;
+}
+
+void cache::store(draw::shape_type type, const float *record,
+                  const draw::util::capture &capture) {
+    const auto key = make_key(type, record);
+    const auto hash = ::hash(type, key);
+    auto &entry = g_entries[hash];
+    if (!draw::util::end_capture(capture, entry.mesh)) {
+        g_entries.erase(hash);
+        return;
+    }
+    entry.type = type;
+    entry.key = key;
+    entry.camera_version = g_core.camera_version;
+    entry.last_used = g_frame;
+}
+
+void cache::end_frame() {
+    stats::g_frame.cache_entries = g_entries.size();
+    g_frame++;
+    std::erase_if(g_entries, [](const auto &item) {
+        return g_frame - item.second.last_used > g_max_age;
+    });
+}
+
+void cache::clear() { g_entries.clear(); }
+
+void cache::set_enabled(bool enabled) {
+    g_enabled = enabled;
+    if (!enabled) {
+        g_entries.clear();
+    }
+}
+
+void cache::set_max_age(uint64_t max_age) { g_max_age = max_age; }
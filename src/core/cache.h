@@ -0,0 +1,22 @@
+#pragma once
+
+#include "draw.h"
+
+#include <cstdint>
+
+namespace cache {
+bool is_enabled();
+// mesh emitted by an identical record under the same draw state and camera,
+// nullptr on a miss
+const draw::util::mesh *find(draw::shape_type type, const float *record);
+// keeps what was emitted since capture for the record
+void store(draw::shape_type type, const float *record,
+           const draw::util::capture &capture);
+// evicts entries unused for longer than the max age
+void end_frame();
+void clear();
+// disabling drops every entry
+void set_enabled(bool enabled);
+// in frames, entries unused for longer are evicted
+void set_max_age(uint64_t max_age);
+} // namespace cache
@@ -0,0 +1,597 @@
+#include "math_types.h"
+
+#include "capture.h"
+#include "core.h"
+#include "draw.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+constexpr std::array<uint8_t, 4> magic = {'H', 'B', 'D', 'C'};
+// view, proj, origin, forward, up and screen size
+constexpr size_t camera_size = 43;
+
+// previous values the float deltas are taken against, mirrored by the reader
+struct state {
+    std::array<float, camera_size> camera{};
+    std::array<std::array<float, draw::max_record_size>,
+               draw::record_type_count>
+        records{};
+    std::array<std::array<float, capture::max_instance_record_size>,
+               draw::record_type_count>
+        instances{};
+    std::array<float, 3> position{};
+    draw::style style{};
+};
+
+using chunk = std::vector<uint8_t>;
+
+// shared with the writer thread
+std::mutex g_queue_mutex;
+std::condition_variable g_queue_cv;
+std::deque<chunk> g_queue;
+size_t g_queued_bytes{};
+// written chunks kept for reuse
+std::vector<chunk> g_free;
+bool g_stopping{};
+std::atomic<bool> g_write_failed{};
+
+std::FILE *g_file{};
+std::thread g_thread;
+bool g_capturing{};
+bool g_in_frame{};
+// the next frame is encoded against zeroed state, set at the start and
+// after a dropped frame
+bool g_reset{};
+uint64_t g_frame{};
+std::chrono::steady_clock::time_point g_start{};
+capture::summary g_summary{};
+chunk g_chunk;
+state g_state{};
+
+void put_varint(chunk &out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+void put_u32(chunk &out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out.push_back((uint8_t)(value >> (i * 8)));
+    }
+}
+
+void put_tag(chunk &out, capture::tag tag) { out.push_back((uint8_t)tag); }
+
+void put_delta(chunk &out, const float *values, float *prev, size_t count) {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (std::bit_cast<uint32_t>(values[i]) !=
+            std::bit_cast<uint32_t>(prev[i])) {
+            mask |= 1ull << i;
+        }
+    }
+    put_varint(out, mask);
+    for (size_t i = 0; i < count; i++) {
+        if (mask & (1ull << i)) {
+            put_varint(out, std::bit_cast<uint32_t>(values[i]) ^
+                                std::bit_cast<uint32_t>(prev[i]));
+            prev[i] = values[i];
+        }
+    }
+}
+
+template <typename T> void copy_floats(const T &value, float *&out) {
+    const auto begin = glm::value_ptr(value);
+    out = std::copy_n(begin, sizeof(T) / sizeof(float), out);
+}
+
+template <typename T> void read_floats(T &value, const float *&in) {
+    std::copy_n(in, sizeof(T) / sizeof(float), glm::value_ptr(value));
+    in += sizeof(T) / sizeof(float);
+}
+
+std::array<float, camera_size> to_floats(const matrix_projection &camera) {
+    std::array<float, camera_size> ret{};
+    auto it = ret.data();
+    copy_floats(camera.view, it);
+    copy_floats(camera.proj, it);
+    copy_floats(camera.origin, it);
+    copy_floats(camera.forward, it);
+    copy_floats(camera.up, it);
+    copy_floats(camera.screen_size, it);
+    return ret;
+}
+
+void from_floats(const std::array<float, camera_size> &floats,
+                 matrix_projection &camera) {
+    auto it = floats.data();
+    read_floats(camera.view, it);
+    read_floats(camera.proj, it);
+    read_floats(camera.origin, it);
+    read_floats(camera.forward, it);
+    read_floats(camera.up, it);
+    read_floats(camera.screen_size, it);
+}
+
+void write_loop() {
+    std::unique_lock lock{g_queue_mutex};
+    while (true) {
+        g_queue_cv.wait(lock, [] { return g_stopping || !g_queue.empty(); });
+        if (g_queue.empty()) {
+            return;
+        }
+
+        auto chunk = std::move(g_queue.front());
+        g_queue.pop_front();
+        lock.unlock();
+        if (std::fwrite(chunk.data(), 1, chunk.size(), g_file) !=
+            chunk.size()) {
+            g_write_failed = true;
+        }
+        lock.lock();
+
+        g_queued_bytes -= chunk.size();
+        chunk.clear();
+        g_free.push_back(std::move(chunk));
+    }
+}
+
+// false when the queue is full, chunk is only taken on success
+bool push(chunk &chunk) {
+    {
+        std::lock_guard _{g_queue_mutex};
+        if (g_queue.size() >= capture::max_queued_frames ||
+            g_queued_bytes + chunk.size() > capture::max_queued_bytes) {
+            return false;
+        }
+        g_queued_bytes += chunk.size();
+        g_queue.push_back(std::move(chunk));
+    }
+    g_queue_cv.notify_one();
+    return true;
+}
+
+void put_style() {
+    const auto &core = g_core;
+    auto &style = g_state.style;
+    if (style.num_segments == core.num_segments &&
+        style.thickness == core.outline_tickness &&
+        style.lod_tolerance == core.lod_tolerance) {
+        return;
+    }
+
+    style.num_segments = core.num_segments;
+    style.thickness = core.outline_tickness;
+    style.lod_tolerance = core.lod_tolerance;
+    put_tag(g_chunk, capture::tag::style);
+    put_varint(g_chunk, style.num_segments);
+    put_u32(g_chunk, std::bit_cast<uint32_t>(style.thickness));
+    put_u32(g_chunk, std::bit_cast<uint32_t>(style.lod_tolerance));
+}
+} // namespace
+
+size_t capture::instance_record_size(draw::shape_type type) {
+    switch (type) {
+    case draw::shape_type::sphere:
+        return 4;
+    case draw::shape_type::box:
+    case draw::shape_type::triangle:
+        return 15;
+    default:
+        return 0;
+    }
+}
+
+bool capture::start(const char *path) {
+    if (g_capturing) {
+        return false;
+    }
+
+    g_file = std::fopen(path, "wb");
+    if (g_file == nullptr) {
+        return false;
+    }
+
+    chunk header{magic.begin(), magic.end()};
+    put_u32(header, version);
+    g_write_failed =
+        std::fwrite(header.data(), 1, header.size(), g_file) != header.size();
+
+    g_stopping = false;
+    g_reset = true;
+    g_frame = 0;
+    g_summary = {};
+    g_start = std::chrono::steady_clock::now();
+    g_thread = std::thread(write_loop);
+    g_capturing = true;
+    return true;
+}
+
+std::optional<capture::summary> capture::stop() {
+    if (!g_capturing) {
+        return std::nullopt;
+    }
+
+    g_capturing = false;
+    g_in_frame = false;
+    {
+        std::lock_guard _{g_queue_mutex};
+        g_stopping = true;
+    }
+    g_queue_cv.notify_one();
+    g_thread.join();
+
+    chunk end{};
+    put_tag(end, tag::end);
+    put_varint(end, g_summary.frames);
+    put_varint(end, g_summary.dropped);
+    if (std::fwrite(end.data(), 1, end.size(), g_file) != end.size()) {
+        g_write_failed = true;
+    }
+    if (std::fclose(g_file) != 0) {
+        g_write_failed = true;
+    }
+    g_file = nullptr;
+
+    g_summary.complete = !g_write_failed;
+    return g_summary;
+}
+
+bool capture::is_capturing() { return g_capturing; }
+
+void capture::begin_frame(const matrix_projection &camera) {
+    if (!g_capturing) {
+        return;
+    }
+
+    if (g_chunk.capacity() == 0) {
+        std::lock_guard _{g_queue_mutex};
+        if (!g_free.empty()) {
+            g_chunk = std::move(g_free.back());
+            g_free.pop_back();
+        }
+    }
+    g_chunk.clear();
+
+    uint64_t flags = 0;
+    if (g_reset) {
+        flags |= frame_flags::reset;
+        g_state = {};
+    }
+
+    const std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - g_start;
+    put_tag(g_chunk, tag::frame);
+    put_varint(g_chunk, flags);
+    put_varint(g_chunk, g_frame++);
+    put_varint(g_chunk, (uint64_t)elapsed.count());
+    const auto floats = to_floats(camera);
+    put_delta(g_chunk, floats.data(), g_state.camera.data(), camera_size);
+    g_in_frame = true;
+}
+
+void capture::end_frame() {
+    if (!g_in_frame) {
+        return;
+    }
+
+    g_in_frame = false;
+    if (push(g_chunk)) {
+        g_summary.frames++;
+        g_reset = false;
+    } else {
+        // the reader never sees the state this frame left behind
+        g_summary.dropped++;
+        g_reset = true;
+    }
+}
+
+void capture::record(draw::shape_type type, const float *record) {
+    if (!g_in_frame) {
+        return;
+    }
+
+    put_style();
+    put_tag(g_chunk, tag::shape);
+    g_chunk.push_back((uint8_t)type);
+    put_delta(g_chunk, record, g_state.records[(size_t)type].data(),
+              draw::record_size(type));
+}
+
+void capture::record_instances(draw::shape_type type, const float *record,
+                               std::span<const Vector3f> positions) {
+    if (!g_in_frame) {
+        return;
+    }
+
+    put_style();
+    put_tag(g_chunk, tag::instances);
+    g_chunk.push_back((uint8_t)type);
+    put_delta(g_chunk, record, g_state.instances[(size_t)type].data(),
+              instance_record_size(type));
+    put_varint(g_chunk, positions.size());
+    for (const auto &pos : positions) {
+        put_delta(g_chunk, &pos[0], g_state.position.data(), 3);
+    }
+}
+
+bool capture::reader::open(std::span<const uint8_t> data) {
+    m_data = data;
+    m_pos = 0;
+    error = nullptr;
+    totals.reset();
+    reset();
+
+    uint32_t file_version{};
+    if (data.size() < magic.size() ||
+        !std::equal(magic.begin(), magic.end(), data.begin())) {
+        return fail("not a capture");
+    }
+    m_pos = magic.size();
+    if (!read_u32(file_version)) {
+        return false;
+    }
+    if (file_version != version) {
+        return fail("unsupported version");
+    }
+    return true;
+}
+
+bool capture::reader::next(frame &out) {
+    if (error || totals || m_pos == m_data.size()) {
+        return false;
+    }
+
+    uint8_t tag_byte{};
+    if (!read_u8(tag_byte)) {
+        return false;
+    }
+    if (tag_byte == (uint8_t)tag::end) {
+        capture::summary summary{};
+        if (!read_varint(summary.frames) || !read_varint(summary.dropped)) {
+            return false;
+        }
+        totals = summary;
+        return false;
+    }
+    if (tag_byte != (uint8_t)tag::frame) {
+        return fail("expected a frame");
+    }
+
+    uint64_t flags{};
+    if (!read_varint(flags)) {
+        return false;
+    }
+    if (flags & frame_flags::reset) {
+        reset();
+    }
+    if (!read_varint(out.index) || !read_varint(out.time_us) ||
+        !read_delta(m_camera.data(), m_camera.size())) {
+        return false;
+    }
+    from_floats(m_camera, out.camera);
+
+    out.primitives.clear();
+    out.styles.clear();
+    out.records.clear();
+    out.positions.clear();
+    out.styles.push_back(m_style);
+
+    while (m_pos < m_data.size()) {
+        const auto next_tag = m_data[m_pos];
+        if (next_tag == (uint8_t)tag::frame ||
+            next_tag == (uint8_t)tag::end) {
+            break;
+        }
+        m_pos++;
+
+        if (next_tag == (uint8_t)tag::style) {
+            uint64_t segments{};
+            uint32_t thickness{};
+            uint32_t lod_tolerance{};
+            if (!read_varint(segments) || !read_u32(thickness) ||
+                !read_u32(lod_tolerance)) {
+                return false;
+            }
+            m_style.num_segments =
+                std::max((unsigned)segments, min_segments);
+            m_style.thickness = std::bit_cast<float>(thickness);
+            m_style.lod_tolerance = std::bit_cast<float>(lod_tolerance);
+            out.styles.push_back(m_style);
+            continue;
+        }
+
+        const auto instanced = next_tag == (uint8_t)tag::instances;
+        if (next_tag != (uint8_t)tag::shape && !instanced) {
+            return fail("unknown tag");
+        }
+
+        uint8_t type_byte{};
+        if (!read_u8(type_byte)) {
+            return false;
+        }
+        if (type_byte >= m_records.size()) {
+            return fail("unknown shape type");
+        }
+        const auto type = (draw::shape_type)type_byte;
+
+        frame::primitive primitive{};
+        primitive.type = type;
+        primitive.instanced = instanced;
+        primitive.style = (uint32_t)out.styles.size() - 1;
+        primitive.record = (uint32_t)out.records.size();
+        primitive.position = (uint32_t)out.positions.size();
+        primitive.count = 1;
+
+        if (!instanced) {
+            auto &record = m_records[type_byte];
+            const auto size = draw::record_size(type);
+            if (!read_delta(record.data(), size)) {
+                return false;
+            }
+            out.records.insert(out.records.end(), record.begin(),
+                               record.begin() + size);
+            out.primitives.push_back(primitive);
+            continue;
+        }
+
+        auto &record = m_instances[type_byte];
+        const auto size = instance_record_size(type);
+        if (size == 0) {
+            return fail("shape type can not be instanced");
+        }
+        uint64_t count{};
+        if (!read_delta(record.data(), size) || !read_varint(count)) {
+            return false;
+        }
+        // every position takes at least a byte
+        if (count > m_data.size() - m_pos) {
+            return fail("truncated");
+        }
+        out.records.insert(out.records.end(), record.begin(),
+                           record.begin() + size);
+        for (uint64_t i = 0; i < count; i++) {
+            if (!read_delta(m_position.data(), m_position.size())) {
+                return false;
+            }
+            out.positions.push_back(glm::make_vec3(m_position.data()));
+        }
+        primitive.count = (uint32_t)count;
+        out.primitives.push_back(primitive);
+    }
+    return true;
+}
+
+bool capture::reader::read_u8(uint8_t &out) {
+    if (m_pos >= m_data.size()) {
+        return fail("truncated");
+    }
+    out = m_data[m_pos++];
+    return true;
+}
+
+bool capture::reader::read_u32(uint32_t &out) {
+    if (m_data.size() - m_pos < 4) {
+        return fail("truncated");
+    }
+    out = 0;
+    for (int i = 0; i < 4; i++) {
+        out |= (uint32_t)m_data[m_pos++] << (i * 8);
+    }
+    return true;
+}
+
+bool capture::reader::read_varint(uint64_t &out) {
+    out = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t byte{};
+        if (!read_u8(byte)) {
+            return false;
+        }
+        out |= (uint64_t)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return fail("bad varint");
+}
+
+bool capture::reader::read_delta(float *values, size_t count) {
+    uint64_t mask{};
+    if (!read_varint(mask)) {
+        return false;
+    }
+    if (count < 64 && (mask >> count) != 0) {
+        return fail("bad delta mask");
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if ((mask & (1ull << i)) == 0) {
+            continue;
+        }
+        uint64_t bits{};
+        if (!read_varint(bits)) {
+            return false;
+        }
+        if (bits > UINT32_MAX) {
+            return fail("bad delta");
+        }
+        values[i] = std::bit_cast<float>(std::bit_cast<uint32_t>(values[i]) ^
+                                         (uint32_t)bits);
+    }
+    return true;
+}
+
+bool capture::reader::fail(const char *reason) {
+    error = reason;
+    return false;
+}
+
+void capture::reader::reset() {
+    m_camera = {};
+    m_records = {};
+    m_instances = {};
+    m_position = {};
+    m_style = {};
+}
+
+void capture::draw(const frame &frame) {
+    std::optional<draw::scoped_style> scoped{};
+    uint32_t current_style = UINT32_MAX;
+    for (const auto &primitive : frame.primitives) {
+        if (primitive.style != current_style) {
+            current_style = primitive.style;
+            scoped.reset();
+            scoped.emplace(frame.styles[current_style]);
+        }
+
+        const auto record = frame.records.data() + primitive.record;
+        if (!primitive.instanced) {
+            draw::draw_record(primitive.type, record);
+            continue;
+        }
+
+        const std::span<const Vector3f> positions{
+            frame.positions.data() + primitive.position, primitive.count};
+        const auto size = instance_record_size(primitive.type);
+        const auto color = std::bit_cast<ImU32>(record[size - 3]);
+        const auto outline = record[size - 2] != 0.0f;
+        const auto color_outline = std::bit_cast<ImU32>(record[size - 1]);
+        switch (primitive.type) {
+        case draw::shape_type::sphere:
+            draw::draw_sphere_instances(record[0], positions, color, outline,
+                                        color_outline);
+            break;
+        case draw::shape_type::box:
+            draw::draw_box_instances(glm::make_vec3(record),
+                                     glm::make_mat3(record + 3), positions,
+                                     color, outline, color_outline);
+            break;
+        case draw::shape_type::triangle:
+            draw::draw_triangle_instances(glm::make_vec3(record),
+                                          glm::make_mat3(record + 3),
+                                          positions, color, outline,
+                                          color_outline);
+            break;
+        default:
+            break;
+        }
+    }
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "math_types.h"
+
+#include "draw.h"
+#include "projection.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+// draw stream capture. every frame stores the camera and the primitives that
+// went through the pipeline, in draw::draw_record layouts, together with the
+// segments, thickness and lod they were drawn with.
+//
+// the file is little-endian, a header followed by one chunk per frame and an
+// end chunk:
+//   header     "HBDC", u32 version
+//   frame      tag, varint flags, varint frame, varint us since start,
+//              camera as a float delta
+//   style      tag, varint segments, f32 thickness, f32 lod tolerance
+//   shape      tag, u8 type, record as a float delta
+//   instances  tag, u8 type, instance record as a float delta,
+//              varint count, positions as float deltas
+//   end        tag, varint frames, varint dropped frames
+// a float delta is a varint mask of the floats whose bits changed since the
+// previous one of the same kind, then each changed float xored with its
+// previous bits as a varint. the previous values are zero at the start and
+// after a frame flagged reset
+//
+// frames are encoded on the calling thread and written by a background one,
+// when its queue is full the frame is dropped instead of waiting
+namespace capture {
+constexpr uint32_t version = 1;
+// frames and bytes that may wait for the writer
+constexpr size_t max_queued_frames = 64;
+constexpr size_t max_queued_bytes = 32 << 20;
+
+enum class tag : uint8_t { frame = 1, style, shape, instances, end };
+enum frame_flags : uint64_t { reset = 1 };
+
+// sphere is the radius, box and triangle the extent and a 3x3 rotation,
+// followed by the colors as in draw_record
+constexpr size_t max_instance_record_size = 15;
+size_t instance_record_size(draw::shape_type type);
+
+struct summary {
+    uint64_t frames{};
+    uint64_t dropped{};
+    // false when a write failed and the file is incomplete
+    bool complete{true};
+};
+
+// false when already capturing or path can not be opened
+bool start(const char *path);
+// frame left open is discarded, nullopt when not capturing
+std::optional<summary> stop();
+bool is_capturing();
+
+// nothing is recorded outside of begin_frame and end_frame
+void begin_frame(const matrix_projection &camera);
+void end_frame();
+void record(draw::shape_type type, const float *record);
+void record_instances(draw::shape_type type, const float *record,
+                      std::span<const Vector3f> positions);
+
+// one decoded frame, primitives reference records and positions by offset
+struct frame {
+    struct primitive {
+        draw::shape_type type;
+        bool instanced;
+        uint32_t style;
+        uint32_t record;
+        uint32_t position;
+        uint32_t count;
+    };
+
+    uint64_t index{};
+    uint64_t time_us{};
+    matrix_projection camera{};
+    std::vector<primitive> primitives;
+    std::vector<draw::style> styles;
+    std::vector<float> records;
+    std::vector<Vector3f> positions;
+};
+
+// decodes a capture in place, the data has to outlive the reader
+struct reader {
+    // false when the header does not match
+    bool open(std::span<const uint8_t> data);
+    // false at the end chunk, at the end of a truncated capture or on an
+    // error. out keeps its capacity between frames
+    bool next(frame &out);
+    // set once next failed for a reason other than the end chunk
+    const char *error{};
+    // from the end chunk, once reached
+    std::optional<capture::summary> totals{};
+
+  private:
+    bool read_u8(uint8_t &out);
+    bool read_u32(uint32_t &out);
+    bool read_varint(uint64_t &out);
+    bool read_delta(float *values, size_t count);
+    bool fail(const char *reason);
+    void reset();
+
+    std::span<const uint8_t> m_data;
+    size_t m_pos{};
+    std::array<float, 43> m_camera{};
+    std::array<std::array<float, draw::max_record_size>,
+               draw::record_type_count>
+        m_records{};
+    std::array<std::array<float, max_instance_record_size>,
+               draw::record_type_count>
+        m_instances{};
+    std::array<float, 3> m_position{};
+    draw::style m_style{};
+};
+
+// draws every primitive of a frame through the current g_core projection
+void draw(const frame &frame);
+} // namespace capture
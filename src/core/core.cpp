@@ -0,0 +1,17 @@
+#include "core.h"
+#include "stats.h"
+
+#include <optional>
+
+hbdraw_core g_core{};
+
+std::optional<Vector2f> core::world_to_screen(const Vector3f &pos) {
+    stats::g_frame.projections++;
+    return g_core.projection->world_to_screen(pos);
+}
+
+void core::world_to_screen(const float *x, const float *y, const float *z,
+                           size_t count, Vector2f *out, uint8_t *visible) {
+    stats::g_frame.projections += count;
+    g_core.projection->world_to_screen(x, y, z, count, out, visible);
+}
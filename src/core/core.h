@@ -0,0 +1,36 @@
+#pragma once
+
+#include "imgui.h"
+
+#include "math_types.h"
+#include "projection.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+// state the shapes and draw helpers read, styles swap the settings with
+// draw::scoped_style
+struct hbdraw_core {
+    // drawlist of the current frame
+    ImDrawList *drawlist{};
+    ::projection *projection{};
+    // never below min_segments, lod picks fewer down to min_lod_segments
+    unsigned num_segments = 32;
+    float outline_tickness = 1.0f;
+    float lod_tolerance = 0.0f;
+    // bumped whenever anything that affects projected geometry changes
+    uint64_t camera_version{0};
+};
+
+extern hbdraw_core g_core;
+
+// fewer segments do not close a curve, segment counts from lua are clamped
+constexpr unsigned min_segments = 3;
+
+namespace core {
+// g_core.projection, counted into the frame stats
+std::optional<Vector2f> world_to_screen(const Vector3f &pos);
+void world_to_screen(const float *x, const float *y, const float *z,
+                     size_t count, Vector2f *out, uint8_t *visible);
+} // namespace core
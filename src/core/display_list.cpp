@@ -0,0 +1,266 @@
+#include "math_types.h"
+
+#include "core.h"
+#include "display_list.h"
+#include "draw.h"
+#include "shape/util.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace {
+std::shared_ptr<display_list::list> g_recording{};
+
+bool has_end(draw::shape_type type) {
+    switch (type) {
+    case draw::shape_type::cylinder:
+    case draw::shape_type::ring:
+    case draw::shape_type::capsule:
+    case draw::shape_type::cone:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void push_point(display_list::list &list, const float *point) {
+    list.x.push_back(point[0]);
+    list.y.push_back(point[1]);
+    list.z.push_back(point[2]);
+}
+
+uint16_t get_style_index(display_list::list &list) {
+    const auto &core = g_core;
+    if (!list.styles.empty()) {
+        const auto &last = list.styles.back();
+        if (last.num_segments == core.num_segments &&
+            last.thickness == core.outline_tickness &&
+            last.lod_tolerance == core.lod_tolerance) {
+            return (uint16_t)(list.styles.size() - 1);
+        }
+    }
+
+    draw::style style{};
+    style.num_segments = core.num_segments;
+    style.thickness = core.outline_tickness;
+    style.lod_tolerance = core.lod_tolerance;
+    list.styles.push_back(style);
+    return (uint16_t)(list.styles.size() - 1);
+}
+
+// gram-schmidt in column order, mirrored bases stay mirrored
+Matrix3x3f orthonormalize(const Matrix3x3f &m) {
+    Matrix3x3f ret;
+    ret[0] = glm::normalize(m[0]);
+    ret[1] = glm::normalize(m[1] - glm::dot(m[1], ret[0]) * ret[0]);
+    ret[2] = glm::normalize(m[2] - glm::dot(m[2], ret[0]) * ret[0] -
+                            glm::dot(m[2], ret[1]) * ret[1]);
+    return ret;
+}
+
+// a non uniform transform scales every record along its own axes. exact
+// when the scale is aligned with them, which for spheres is any scale
+// applied before the rotation, sheared records are approximated
+void scale_record(draw::shape_type type, float *record,
+                  const Matrix3x3f &linear, const Vector3f &local_axis) {
+    switch (type) {
+    case draw::shape_type::box:
+    case draw::shape_type::triangle:
+    case draw::shape_type::ellipsoid: {
+        const auto axes = linear * Matrix3x3f(glm::make_mat4(record + 6));
+        for (int i = 0; i < 3; i++) {
+            record[3 + i] *= glm::length(axes[i]);
+        }
+        const Matrix4x4f world_rot{orthonormalize(axes)};
+        std::memcpy(record + 6, &world_rot[0][0], sizeof(float) * 16);
+        break;
+    }
+    case draw::shape_type::ring:
+    case draw::shape_type::cone:
+    case draw::shape_type::cylinder:
+    case draw::shape_type::capsule: {
+        // radii are scaled by the mean scale across the axis, or over all
+        // axes when start and end meet
+        const auto length_sq = glm::dot(local_axis, local_axis);
+        float scale = 0.0f;
+        if (length_sq == 0.0f) {
+            for (int i = 0; i < 3; i++) {
+                scale += glm::length(linear[i]) / 3.0f;
+            }
+        } else {
+            auto u = glm::cross(local_axis, Vector3f{1.0f, 0.0f, 0.0f});
+            if (glm::dot(u, u) < 1e-6f * length_sq) {
+                u = glm::cross(local_axis, Vector3f{0.0f, 1.0f, 0.0f});
+            }
+            u = glm::normalize(u);
+            const auto v = glm::normalize(glm::cross(local_axis, u));
+            scale = (glm::length(linear * u) + glm::length(linear * v)) * 0.5f;
+        }
+        record[6] *= scale;
+        if (type == draw::shape_type::ring ||
+            type == draw::shape_type::cone) {
+            record[7] *= scale;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+// spheres do not stay spheres, they are drawn as the ellipsoid along the
+// transformed axes
+void draw_scaled_sphere(const float *record, const Matrix3x3f &linear,
+                        const Vector3f &axis_scale) {
+    draw::draw_ellipsoid(glm::make_vec3(record), axis_scale * record[3],
+                         Matrix4x4f(orthonormalize(linear)),
+                         std::bit_cast<ImU32>(record[4]), record[5] != 0.0f,
+                         std::bit_cast<ImU32>(record[6]));
+}
+} // namespace
+
+void display_list::begin() { g_recording = std::make_shared<list>(); }
+
+std::shared_ptr<display_list::list> display_list::end() {
+    return std::exchange(g_recording, nullptr);
+}
+
+bool display_list::is_recording() { return g_recording != nullptr; }
+
+void display_list::record(draw::shape_type type, const float *record) {
+    auto &list = *g_recording;
+    list.types.push_back(type);
+    list.records.insert(list.records.end(), record,
+                        record + draw::record_size(type));
+    list.style_index.push_back(get_style_index(list));
+
+    push_point(list, record);
+    if (has_end(type)) {
+        push_point(list, record + 3);
+    }
+}
+
+void display_list::abort() { g_recording = nullptr; }
+
+void display_list::draw_list(const list &list, const Matrix4x4f &transform) {
+    static std::vector<float> xs;
+    static std::vector<float> ys;
+    static std::vector<float> zs;
+
+    const auto count = list.x.size();
+    xs.resize(count);
+    ys.resize(count);
+    zs.resize(count);
+
+    // one pass per component over contiguous arrays, vectorizes cleanly
+    const auto &t = transform;
+    for (size_t i = 0; i < count; i++) {
+        xs[i] = t[0][0] * list.x[i] + t[1][0] * list.y[i] +
+                t[2][0] * list.z[i] + t[3][0];
+    }
+    for (size_t i = 0; i < count; i++) {
+        ys[i] = t[0][1] * list.x[i] + t[1][1] * list.y[i] +
+                t[2][1] * list.z[i] + t[3][1];
+    }
+    for (size_t i = 0; i < count; i++) {
+        zs[i] = t[0][2] * list.x[i] + t[1][2] * list.y[i] +
+                t[2][2] * list.z[i] + t[3][2];
+    }
+
+    const Matrix3x3f linear{transform};
+    const Vector3f axis_scale{glm::length(linear[0]), glm::length(linear[1]),
+                              glm::length(linear[2])};
+    if (axis_scale.x <= 0.0f || axis_scale.y <= 0.0f || axis_scale.z <= 0.0f) {
+        return;
+    }
+    const auto scale = axis_scale.x;
+    const auto rot = Matrix4x4f(linear * (1.0f / scale));
+    const auto is_uniform = is_orthonormal(Matrix3x3f(rot));
+
+    std::array<float, draw::max_record_size> record;
+    std::optional<draw::scoped_style> scoped{};
+    int current_style = -1;
+    const float *src = list.records.data();
+    size_t point = 0;
+
+    for (size_t i = 0; i < list.types.size(); i++) {
+        const auto type = list.types[i];
+        const auto size = draw::record_size(type);
+        std::copy_n(src, size, record.begin());
+        src += size;
+
+        if (list.style_index[i] != current_style) {
+            current_style = list.style_index[i];
+            scoped.reset();
+            scoped.emplace(list.styles[current_style]);
+        }
+
+        record[0] = xs[point];
+        record[1] = ys[point];
+        record[2] = zs[point];
+        point++;
+
+        if (!is_uniform) {
+            if (type == draw::shape_type::sphere) {
+                draw_scaled_sphere(record.data(), linear, axis_scale);
+                continue;
+            }
+            Vector3f local_axis{};
+            if (has_end(type)) {
+                local_axis = Vector3f{list.x[point], list.y[point],
+                                      list.z[point]} -
+                             Vector3f{list.x[point - 1], list.y[point - 1],
+                                      list.z[point - 1]};
+                record[3] = xs[point];
+                record[4] = ys[point];
+                record[5] = zs[point];
+                point++;
+            }
+            scale_record(type, record.data(), linear, local_axis);
+            draw::draw_record(type, record.data());
+            continue;
+        }
+
+        switch (type) {
+        case draw::shape_type::sphere:
+            record[3] *= scale;
+            break;
+        case draw::shape_type::box:
+        case draw::shape_type::triangle:
+        case draw::shape_type::ellipsoid: {
+            record[3] *= scale;
+            record[4] *= scale;
+            record[5] *= scale;
+            const auto local_rot = glm::make_mat4(record.data() + 6);
+            const Matrix4x4f world_rot = rot * local_rot;
+            std::memcpy(record.data() + 6, &world_rot[0][0],
+                        sizeof(float) * 16);
+            break;
+        }
+        case draw::shape_type::ring:
+        case draw::shape_type::cone:
+            record[7] *= scale;
+            [[fallthrough]];
+        case draw::shape_type::cylinder:
+        case draw::shape_type::capsule:
+            record[3] = xs[point];
+            record[4] = ys[point];
+            record[5] = zs[point];
+            record[6] *= scale;
+            point++;
+            break;
+        case draw::shape_type::hull:
+        case draw::shape_type::trail:
+        case draw::shape_type::lines:
+        case draw::shape_type::labels:
+            break;
+        }
+
+        draw::draw_record(type, record.data());
+    }
+}
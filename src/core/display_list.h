@@ -0,0 +1,42 @@
+#pragma once
+
+#include "math_types.h"
+
+#include "draw.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace display_list {
+// primitives recorded in local space, flattened into draw::draw_record
+// layouts with their points split out so a replay transforms them in one pass
+struct list {
+    std::vector<draw::shape_type> types;
+    std::vector<float> records;
+    // segments, thickness and lod each record was recorded with
+    std::vector<uint16_t> style_index;
+    std::vector<draw::style> styles;
+
+    // local points of every record, records own 1 or 2 in order
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+};
+
+// primitives drawn until end are recorded instead, a list has to be finished
+// in the same frame. only the shapes with a flat record, spheres to cones and
+// their instances, can be recorded. lines, arrows, axes and labels drawn
+// while recording are skipped
+void begin();
+std::shared_ptr<list> end();
+bool is_recording();
+// stores the record instead of drawing it
+void record(draw::shape_type type, const float *record);
+// drops a list left open by a script, nothing may be recorded outside of lua
+// calls
+void abort();
+// non uniform scale is applied along the own axes of every record, spheres
+// turn into ellipsoids
+void draw_list(const list &list, const Matrix4x4f &transform);
+} // namespace display_list
@@ -0,0 +1,1151 @@
+#include "imgui.h"
+#include "math_types.h"
+
+#include "cache.h"
+#include "capture.h"
+#include "core.h"
+#include "display_list.h"
+#include "draw.h"
+#include "memory.h"
+#include "profiler.h"
+#include "stats.h"
+#include "shape/util.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace {
+std::span<const float> as_span(const Vector3f &v) { return {&v[0], 3}; }
+std::span<const float> as_span(const Matrix3x3f &m) { return {&m[0][0], 9}; }
+std::span<const float> as_span(const Matrix4x4f &m) { return {&m[0][0], 16}; }
+
+using record_args = std::initializer_list<std::span<const float>>;
+
+// args followed by the colors, as draw_record reads them
+std::array<float, draw::max_record_size>
+make_record(record_args args, ImU32 color, bool outline, ImU32 color_outline) {
+    std::array<float, draw::max_record_size> ret;
+    auto it = ret.begin();
+    for (const auto &arg : args) {
+        it = std::copy(arg.begin(), arg.end(), it);
+    }
+    *it++ = std::bit_cast<float>(color);
+    *it++ = outline ? 1.0f : 0.0f;
+    *it++ = std::bit_cast<float>(color_outline);
+    return ret;
+}
+
+// common path of the per-call draws, args are the draw_record layout before
+// the colors. the call is recorded into an open display list, or counted,
+// looked up in the cache and drawn by draw_shape(scope)
+template <typename F>
+void submit(draw::shape_type type, record_args args, ImU32 color,
+            bool outline, ImU32 color_outline, F &&draw_shape) {
+    const auto record = make_record(args, color, outline, color_outline);
+    if (display_list::is_recording()) {
+        display_list::record(type, record.data());
+        return;
+    }
+
+    stats::shape_scope scope{type};
+    if (scope.m_dropped) {
+        return;
+    }
+    capture::record(type, record.data());
+
+    const auto construct = [&] {
+        const memory::scope _{memory::subsystem::construct};
+        draw_shape(scope);
+    };
+    if (!cache::is_enabled()) {
+        construct();
+        return;
+    }
+
+    if (const auto mesh = cache::find(type, record.data())) {
+        draw::util::replay(*mesh);
+        return;
+    }
+    const auto capture = draw::util::begin_capture();
+    construct();
+    cache::store(type, record.data(), capture);
+}
+
+// scratch of the instanced draws, point k of instance i is at i * S + k
+struct instances {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<Vector2f> screen;
+    std::vector<uint8_t> visible;
+};
+
+template <size_t S>
+const instances &project_instances(const std::array<Vector3f, S> &local,
+                                   std::span<const Vector3f> positions) {
+    static instances ret;
+    const auto count = positions.size() * S;
+    ret.x.resize(count);
+    ret.y.resize(count);
+    ret.z.resize(count);
+    ret.screen.resize(count);
+    ret.visible.resize(count);
+
+    for (size_t i = 0; i < positions.size(); i++) {
+        for (size_t k = 0; k < S; k++) {
+            ret.x[i * S + k] = positions[i].x + local[k].x;
+            ret.y[i * S + k] = positions[i].y + local[k].y;
+            ret.z[i * S + k] = positions[i].z + local[k].z;
+        }
+    }
+
+    core::world_to_screen(ret.x.data(), ret.y.data(), ret.z.data(), count,
+                           ret.screen.data(), ret.visible.data());
+    return ret;
+}
+
+template <size_t S>
+std::optional<std::array<Vector2f, S>> get_instance(const instances &in,
+                                                    size_t i) {
+    std::array<Vector2f, S> ret;
+    for (size_t k = 0; k < S; k++) {
+        if (!in.visible[i * S + k]) {
+            return std::nullopt;
+        }
+        ret[k] = in.screen[i * S + k];
+    }
+    return ret;
+}
+} // namespace
+
+draw::scoped_style::scoped_style(const style &style)
+    : m_num_segments(g_core.num_segments),
+      m_outline_tickness(g_core.outline_tickness),
+      m_lod_tolerance(g_core.lod_tolerance) {
+    g_core.num_segments = style.num_segments;
+    g_core.outline_tickness = style.thickness;
+    g_core.lod_tolerance = style.lod_tolerance;
+}
+
+draw::scoped_style::~scoped_style() {
+    g_core.num_segments = m_num_segments;
+    g_core.outline_tickness = m_outline_tickness;
+    g_core.lod_tolerance = m_lod_tolerance;
+}
+
+draw::util::capture draw::util::begin_capture() {
+    const auto drawlist = g_core.drawlist;
+    return {drawlist->VtxBuffer.Size, drawlist->IdxBuffer.Size,
+            drawlist->CmdBuffer.Size, drawlist->_CmdHeader.VtxOffset,
+            drawlist->_VtxCurrentIdx};
+}
+
+bool draw::util::end_capture(const capture &capture, mesh &out) {
+    const auto drawlist = g_core.drawlist;
+    out.vtx.clear();
+    out.idx.clear();
+
+    // drawlist switched to a new vtx offset midway, indices no longer share
+    // one base. an empty command gets the new offset in place instead of a
+    // new command being added, so the command count alone misses it
+    if (drawlist->CmdBuffer.Size != capture.cmd_count ||
+        drawlist->_CmdHeader.VtxOffset != capture.vtx_offset ||
+        drawlist->_VtxCurrentIdx < capture.vtx_current_idx) {
+        return false;
+    }
+
+    out.vtx.assign(drawlist->VtxBuffer.Data + capture.vtx_begin,
+                   drawlist->VtxBuffer.Data + drawlist->VtxBuffer.Size);
+    out.idx.reserve(drawlist->IdxBuffer.Size - capture.idx_begin);
+    for (int i = capture.idx_begin; i < drawlist->IdxBuffer.Size; i++) {
+        out.idx.push_back(
+            (ImDrawIdx)(drawlist->IdxBuffer.Data[i] - capture.vtx_current_idx));
+    }
+    return true;
+}
+
+void draw::util::replay(const mesh &mesh) {
+    if (mesh.idx.empty()) {
+        return;
+    }
+
+    const auto drawlist = g_core.drawlist;
+    const auto vtx_count = (int)mesh.vtx.size();
+    const auto idx_count = (int)mesh.idx.size();
+    // may start a new vtx offset, so base has to be read afterwards
+    drawlist->PrimReserve(idx_count, vtx_count);
+
+    const auto base = drawlist->_VtxCurrentIdx;
+    std::memcpy(drawlist->_VtxWritePtr, mesh.vtx.data(),
+                vtx_count * sizeof(ImDrawVert));
+    for (int i = 0; i < idx_count; i++) {
+        drawlist->_IdxWritePtr[i] = (ImDrawIdx)(base + mesh.idx[i]);
+    }
+
+    drawlist->_VtxWritePtr += vtx_count;
+    drawlist->_IdxWritePtr += idx_count;
+    drawlist->_VtxCurrentIdx += vtx_count;
+}
+
+bool draw::util::replay_retained(const mesh &mesh, bool dirty,
+                                 uint64_t camera_version) {
+    if (dirty || camera_version != g_core.camera_version ||
+        ::capture::is_capturing()) {
+        return false;
+    }
+    replay(mesh);
+    stats::add_replayed(mesh.vtx.size());
+    return true;
+}
+
+void draw::util::paint(ImU32 color, bool outline, ImU32 color_outline,
+                       ImDrawFlags stroke_flags, fill_type fill_type) {
+    HB_DRAW_ZONE("util::paint");
+    const auto drawlist = g_core.drawlist;
+    switch (fill_type) {
+    case fill_type::convex:
+        drawlist->AddConvexPolyFilled(drawlist->_Path.Data,
+                                      drawlist->_Path.Size, color);
+        break;
+    case fill_type::concave:
+        drawlist->AddConcavePolyFilled(drawlist->_Path.Data,
+                                       drawlist->_Path.Size, color);
+        break;
+    }
+    if (outline) {
+        drawlist->AddPolyline(drawlist->_Path.Data, drawlist->_Path.Size,
+                              color_outline, stroke_flags,
+                              g_core.outline_tickness);
+    }
+    drawlist->PathClear();
+}
+
+void draw::util::draw_ellipse(const ImVec2 &center, float radius_x,
+                              float radius_y, float rot, float a_min,
+                              float a_max, ImU32 color, int num_segments,
+                              float thickness, ImDrawFlags flags) {
+    HB_DRAW_ZONE("util::draw_ellipse");
+    const auto drawlist = g_core.drawlist;
+    drawlist->PathEllipticalArcTo(center, ImVec2(radius_x, radius_y), rot,
+                                  a_min, a_max, num_segments);
+    drawlist->AddPolyline(drawlist->_Path.Data, drawlist->_Path.Size, color,
+                          flags, thickness);
+    drawlist->PathClear();
+}
+
+void draw::util::path_points(const std::vector<Vector2f *> *points,
+                             bool reverse) {
+    const auto drawlist = g_core.drawlist;
+    const auto size = points->size();
+    if (points->empty()) {
+        return;
+    }
+
+    const auto vec = *points;
+    if (reverse) {
+        for (int i = size - 1; i >= 0; i--) {
+            drawlist->PathLineToMergeDuplicate(to_imvec(*vec[i]));
+        }
+    } else {
+        for (size_t i = 0; i < size; i++) {
+            drawlist->PathLineToMergeDuplicate(to_imvec(*vec[i]));
+        }
+    }
+}
+
+void draw::util::path_points_duplicate(const std::vector<Vector2f *> *points,
+                                       bool reverse) {
+    const auto drawlist = g_core.drawlist;
+    const auto size = points->size();
+    if (points->empty()) {
+        return;
+    }
+
+    const auto vec = *points;
+    if (reverse) {
+        for (int i = size - 1; i > 0; i--) {
+            drawlist->PathLineTo(to_imvec(*vec[i]));
+            drawlist->PathLineTo(to_imvec(*vec[i - 1]));
+        }
+    } else {
+        for (size_t i = 0; i < size - 1; i++) {
+            drawlist->PathLineTo(to_imvec(*vec[i]));
+            drawlist->PathLineTo(to_imvec(*vec[i + 1]));
+        }
+    }
+}
+
+size_t draw::record_size(shape_type type) {
+    switch (type) {
+    case shape_type::sphere:
+        return 7;
+    case shape_type::box:
+    case shape_type::triangle:
+    case shape_type::ellipsoid:
+        return 25;
+    case shape_type::cylinder:
+    case shape_type::capsule:
+        return 10;
+    case shape_type::ring:
+    case shape_type::cone:
+        return 11;
+    case shape_type::hull:
+    case shape_type::trail:
+    case shape_type::lines:
+    case shape_type::labels:
+        break;
+    }
+    return 0;
+}
+
+void draw::draw_record(shape_type type, const float *record) {
+    const auto size = record_size(type);
+    const auto color = std::bit_cast<ImU32>(record[size - 3]);
+    const auto outline = record[size - 2] != 0.0f;
+    const auto color_outline = std::bit_cast<ImU32>(record[size - 1]);
+
+    switch (type) {
+    case shape_type::sphere:
+        draw_sphere(glm::make_vec3(record), record[3], color, outline,
+                    color_outline);
+        break;
+    case shape_type::box:
+        draw_box(glm::make_vec3(record), glm::make_vec3(record + 3),
+                 glm::make_mat4(record + 6), color, outline, color_outline);
+        break;
+    case shape_type::triangle:
+        draw_triangle(glm::make_vec3(record), glm::make_vec3(record + 3),
+                      glm::make_mat4(record + 6), color, outline,
+                      color_outline);
+        break;
+    case shape_type::cylinder:
+        draw_cylinder(glm::make_vec3(record), glm::make_vec3(record + 3),
+                      record[6], color, outline, color_outline);
+        break;
+    case shape_type::ring:
+        draw_ring(glm::make_vec3(record), glm::make_vec3(record + 3),
+                  record[6], record[7], color, outline, color_outline);
+        break;
+    case shape_type::capsule:
+        draw_capsule(glm::make_vec3(record), glm::make_vec3(record + 3),
+                     record[6], color, outline, color_outline);
+        break;
+    case shape_type::ellipsoid:
+        draw_ellipsoid(glm::make_vec3(record), glm::make_vec3(record + 3),
+                       glm::make_mat4(record + 6), color, outline,
+                       color_outline);
+        break;
+    case shape_type::cone:
+        draw_cone(glm::make_vec3(record), glm::make_vec3(record + 3),
+                  record[6], record[7], color, outline, color_outline);
+        break;
+    case shape_type::hull:
+    case shape_type::trail:
+    case shape_type::lines:
+    case shape_type::labels:
+        break;
+    }
+}
+
+void draw::draw_sphere(const Vector3f &center, float radius, ImU32 color,
+                       bool outline, ImU32 color_outline) {
+    submit(shape_type::sphere, {as_span(center), {&radius, 1}}, color,
+           outline, color_outline, [&](stats::shape_scope &scope) {
+               const auto sphere = Sphere(center, radius);
+               if (!sphere.m_is_ok) {
+                   return;
+               }
+               scope.constructed();
+               draw(sphere, color, outline, color_outline);
+           });
+}
+
+void draw::draw_box(const Vector3f &pos, const Vector3f &extent,
+                    const Matrix4x4f &rot, ImU32 color, bool outline,
+                    ImU32 color_outline) {
+    draw_box(pos, extent, Matrix3x3f(rot), color, outline, color_outline);
+}
+
+void draw::draw_box(const Vector3f &pos, const Vector3f &extent,
+                    const Matrix3x3f &rot, ImU32 color, bool outline,
+                    ImU32 color_outline) {
+    submit(shape_type::box,
+           {as_span(pos), as_span(extent), as_span(Matrix4x4f(rot))}, color,
+           outline, color_outline, [&](stats::shape_scope &scope) {
+               const auto box = Box(pos, extent, get_basis(rot));
+               if (!box.m_is_ok) {
+                   return;
+               }
+               scope.constructed();
+               draw(box, color, outline, color_outline);
+           });
+}
+
+void draw::draw_box(const Vector3f &pos, const Vector3f &extent,
+                    const glm::quat &rot, ImU32 color, bool outline,
+                    ImU32 color_outline) {
+    submit(shape_type::box,
+           {as_span(pos), as_span(extent), as_span(glm::mat4_cast(rot))},
+           color, outline, color_outline, [&](stats::shape_scope &scope) {
+               const auto box = Box(pos, extent, glm::mat3_cast(rot));
+               if (!box.m_is_ok) {
+                   return;
+               }
+               scope.constructed();
+               draw(box, color, outline, color_outline);
+           });
+}
+
+void draw::draw_triangle(const Vector3f &pos, const Vector3f &extent,
+                         const Matrix4x4f &rot, ImU32 color, bool outline,
+                         ImU32 color_outline) {
+    draw_triangle(pos, extent, Matrix3x3f(rot), color, outline,
+                  color_outline);
+}
+
+void draw::draw_triangle(const Vector3f &pos, const Vector3f &extent,
+                         const Matrix3x3f &rot, ImU32 color, bool outline,
+                         ImU32 color_outline) {
+    submit(shape_type::triangle,
+           {as_span(pos), as_span(extent), as_span(Matrix4x4f(rot))}, color,
+           outline, color_outline, [&](stats::shape_scope &scope) {
+               const auto triangle = Triangle(pos, extent, get_basis(rot));
+               if (!triangle.m_is_ok) {
+                   return;
+               }
+               scope.constructed();
+               draw(triangle, color, outline, color_outline);
+           });
+}
+
+void draw::draw_triangle(const Vector3f &pos, const Vector3f &extent,
+                         const glm::quat &rot, ImU32 color, bool outline,
+                         ImU32 color_outline) {
+    submit(shape_type::triangle,
+           {as_span(pos), as_span(extent), as_span(glm::mat4_cast(rot))},
+           color, outline, color_outline, [&](stats::shape_scope &scope) {
+               const auto triangle =
+                   Triangle(pos, extent, glm::mat3_cast(rot));
+               if (!triangle.m_is_ok) {
+                   return;
+               }
+               scope.constructed();
+               draw(triangle, color, outline, color_outline);
+           });
+}
+
+void draw::draw_cylinder(const Vector3f &start, const Vector3f &end,
+                         float radius, ImU32 color, bool outline,
+                         ImU32 color_outline) {
+    // without an axis it is a sphere, drawn and counted as one
+    if (glm::length(end - start) <= 0.0f) {
+        return draw_sphere(start, radius, color, outline, color_outline);
+    }
+    submit(shape_type::cylinder, {as_span(start), as_span(end), {&radius, 1}},
+           color, outline, color_outline, [&](stats::shape_scope &scope) {
+               const auto cylinder = Cylinder(start, end, radius);
+               if (!cylinder.m_is_ok) {
+                   return;
+               }
+               scope.constructed();
+               draw(cylinder, color, outline, color_outline);
+           });
+}
+
+void draw::draw_ring(const Vector3f &start, const Vector3f &end, float radius_a,
+                     float radius_b, ImU32 color, bool outline,
+                     ImU32 color_outline) {
+    submit(shape_type::ring,
+           {as_span(start), as_span(end), {&radius_a, 1}, {&radius_b, 1}},
+           color, outline, color_outline, [&](stats::shape_scope &scope) {
+               const auto ring = Ring(start, end, radius_a, radius_b);
+               if (!ring.m_is_ok) {
+                   return;
+               }
+               scope.constructed();
+               draw(ring, color, outline, color_outline);
+           });
+}
+
+void draw::draw_capsule(const Vector3f &start, const Vector3f &end,
+                        float radius, ImU32 color, bool outline,
+                        ImU32 color_outline) {
+    // without an axis it is a sphere, drawn and counted as one
+    if (glm::length(end - start) <= 0.0f) {
+        return draw_sphere(start, radius, color, outline, color_outline);
+    }
+    submit(shape_type::capsule, {as_span(start), as_span(end), {&radius, 1}},
+           color, outline, color_outline, [&](stats::shape_scope &scope) {
+               const auto capsule = Capsule(start, end, radius);
+               if (!capsule.m_is_ok) {
+                   return;
+               }
+               scope.constructed();
+               draw(capsule, color, outline, color_outline);
+           });
+}
+
+void draw::draw_cone(const Vector3f &start, const Vector3f &end,
+                     float radius_start, float radius_end, ImU32 color,
+                     bool outline, ImU32 color_outline) {
+    submit(shape_type::cone,
+           {as_span(start), as_span(end), {&radius_start, 1}, {&radius_end, 1}},
+           color, outline, color_outline, [&](stats::shape_scope &scope) {
+               // without a height there is no axis to build the ends around
+               if (glm::length(end - start) <= 0.0f) {
+                   return;
+               }
+               const auto cone = Cylinder(start, end, radius_start,
+                                          radius_end, 0.0f, false, 0);
+               if (!cone.m_is_ok) {
+                   return;
+               }
+               scope.constructed();
+               draw(cone, color, outline, color_outline);
+           });
+}
+
+void draw::draw_ellipsoid(const Vector3f &center, const Vector3f &radii,
+                          const Matrix4x4f &rot, ImU32 color, bool outline,
+                          ImU32 color_outline) {
+    draw_ellipsoid(center, radii, Matrix3x3f(rot), color, outline,
+                   color_outline);
+}
+
+void draw::draw_ellipsoid(const Vector3f &center, const Vector3f &radii,
+                          const Matrix3x3f &rot, ImU32 color, bool outline,
+                          ImU32 color_outline) {
+    submit(shape_type::ellipsoid,
+           {as_span(center), as_span(radii), as_span(Matrix4x4f(rot))}, color,
+           outline, color_outline, [&](stats::shape_scope &scope) {
+               const auto ellipsoid = Ellipsoid(center, radii, get_basis(rot));
+               if (!ellipsoid.m_is_ok) {
+                   return;
+               }
+               scope.constructed();
+               draw(ellipsoid, color, outline, color_outline);
+           });
+}
+
+void draw::draw_ellipsoid(const Vector3f &center, const Vector3f &radii,
+                          const glm::quat &rot, ImU32 color, bool outline,
+                          ImU32 color_outline) {
+    submit(shape_type::ellipsoid,
+           {as_span(center), as_span(radii), as_span(glm::mat4_cast(rot))},
+           color, outline, color_outline, [&](stats::shape_scope &scope) {
+               const auto ellipsoid =
+                   Ellipsoid(center, radii, glm::mat3_cast(rot));
+               if (!ellipsoid.m_is_ok) {
+                   return;
+               }
+               scope.constructed();
+               draw(ellipsoid, color, outline, color_outline);
+           });
+}
+
+void draw::draw_hull(const hull::mesh &mesh, const Vector3f &pos,
+                     const Matrix3x3f &rot, ImU32 color, bool outline,
+                     ImU32 color_outline) {
+    stats::shape_scope scope{shape_type::hull};
+    if (scope.m_dropped) {
+        return;
+    }
+    const memory::scope _{memory::subsystem::construct};
+    const auto hull = Hull(mesh, pos, rot);
+    if (!hull.m_is_ok) {
+        return;
+    }
+    scope.constructed();
+    draw(hull, color, outline, color_outline);
+}
+
+void draw::draw_trail(const trail::history &history) {
+    stats::shape_scope scope{shape_type::trail};
+    if (scope.m_dropped) {
+        return;
+    }
+    const memory::scope _{memory::subsystem::construct};
+    const auto trail = Trail(history);
+    if (!trail.m_is_ok) {
+        return;
+    }
+    scope.constructed();
+    draw(trail);
+}
+
+void draw::draw_sphere_instances(float radius,
+                                 std::span<const Vector3f> positions,
+                                 ImU32 color, bool outline,
+                                 ImU32 color_outline) {
+    if (display_list::is_recording()) {
+        for (const auto &pos : positions) {
+            draw_sphere(pos, radius, color, outline, color_outline);
+        }
+        return;
+    }
+
+    if (capture::is_capturing()) {
+        const auto record =
+            make_record({{&radius, 1}}, color, outline, color_outline);
+        capture::record_instances(shape_type::sphere, record.data(),
+                                  positions);
+    }
+
+    // same top point as get_screen_radius
+    const std::array<Vector3f, 2> local = {
+        Vector3f{0.0f},
+        glm::normalize(g_core.projection->get_up()) * radius};
+    const memory::scope _{memory::subsystem::construct};
+    const auto &projected = project_instances(local, positions);
+    for (size_t i = 0; i < positions.size(); i++) {
+        stats::shape_scope scope{shape_type::sphere};
+        if (scope.m_dropped) {
+            continue;
+        }
+        const auto points = get_instance<2>(projected, i);
+        if (!points) {
+            continue;
+        }
+        const auto sphere =
+            Sphere((*points)[0], glm::length((*points)[1] - (*points)[0]));
+        scope.constructed();
+        draw(sphere, color, outline, color_outline);
+    }
+}
+
+void draw::draw_box_instances(const Vector3f &extent, const Matrix3x3f &rot,
+                              std::span<const Vector3f> positions, ImU32 color,
+                              bool outline, ImU32 color_outline) {
+    if (display_list::is_recording()) {
+        for (const auto &pos : positions) {
+            draw_box(pos, extent, rot, color, outline, color_outline);
+        }
+        return;
+    }
+
+    if (capture::is_capturing()) {
+        const auto record = make_record({as_span(extent), as_span(rot)},
+                                        color, outline, color_outline);
+        capture::record_instances(shape_type::box, record.data(), positions);
+    }
+
+    const auto local = transform_points(Vector3f{0.0f}, extent, get_basis(rot),
+                                        Box::sx, Box::sy, Box::sz);
+    const memory::scope _{memory::subsystem::construct};
+    const auto &projected = project_instances(local, positions);
+    for (size_t i = 0; i < positions.size(); i++) {
+        stats::shape_scope scope{shape_type::box};
+        if (scope.m_dropped) {
+            continue;
+        }
+        const auto points = get_instance<8>(projected, i);
+        if (!points) {
+            continue;
+        }
+        const auto box = Box(*points);
+        if (!box.m_is_ok) {
+            continue;
+        }
+        scope.constructed();
+        draw(box, color, outline, color_outline);
+    }
+}
+
+void draw::draw_triangle_instances(const Vector3f &extent,
+                                   const Matrix3x3f &rot,
+                                   std::span<const Vector3f> positions,
+                                   ImU32 color, bool outline,
+                                   ImU32 color_outline) {
+    if (display_list::is_recording()) {
+        for (const auto &pos : positions) {
+            draw_triangle(pos, extent, rot, color, outline, color_outline);
+        }
+        return;
+    }
+
+    if (capture::is_capturing()) {
+        const auto record = make_record({as_span(extent), as_span(rot)},
+                                        color, outline, color_outline);
+        capture::record_instances(shape_type::triangle, record.data(),
+                                  positions);
+    }
+
+    const auto local = transform_points(Vector3f{0.0f}, extent, get_basis(rot),
+                                        Triangle::sx, Triangle::sy,
+                                        Triangle::sz);
+    const memory::scope _{memory::subsystem::construct};
+    const auto &projected = project_instances(local, positions);
+    for (size_t i = 0; i < positions.size(); i++) {
+        stats::shape_scope scope{shape_type::triangle};
+        if (scope.m_dropped) {
+            continue;
+        }
+        const auto points = get_instance<6>(projected, i);
+        if (!points) {
+            continue;
+        }
+        const auto triangle = Triangle(*points);
+        if (!triangle.m_is_ok) {
+            continue;
+        }
+        scope.constructed();
+        draw(triangle, color, outline, color_outline);
+    }
+}
+
+void draw::draw(const Box &shape, ImU32 color, bool outline,
+                ImU32 color_outline) {
+    if (!shape.m_is_ok) {
+        return;
+    }
+    const auto drawlist = g_core.drawlist;
+    for (auto &quad : shape.m_quads) {
+        const auto arr = *quad;
+        drawlist->PathLineTo(to_imvec(*arr[0]));
+        drawlist->PathLineTo(to_imvec(*arr[1]));
+        drawlist->PathLineTo(to_imvec(*arr[2]));
+        drawlist->PathLineTo(to_imvec(*arr[3]));
+
+        util::paint(color, outline, color_outline);
+    }
+}
+
+void draw::draw(const Sphere &shape, ImU32 color, bool outline,
+                ImU32 color_outline) {
+    if (!shape.m_is_ok) {
+        return;
+    }
+    const auto drawlist = g_core.drawlist;
+    const auto center = to_imvec(shape.m_center);
+    const auto num_segments = get_num_segments(shape.m_radius);
+    drawlist->AddCircleFilled(center, shape.m_radius, color, num_segments);
+
+    if (outline) {
+        const float minor_radius = shape.m_radius * std::cos(45);
+        const auto rad = glm::radians(180.0f);
+        drawlist->AddCircle(center, shape.m_radius, color_outline,
+                            num_segments);
+        util::draw_ellipse(center, shape.m_radius, minor_radius, 0, 0, rad,
+                           color_outline, num_segments,
+                           g_core.outline_tickness);
+        util::draw_ellipse(center, shape.m_radius, minor_radius, 90, 0, rad,
+                           color_outline, num_segments,
+                           g_core.outline_tickness);
+        util::draw_ellipse(center, shape.m_radius, minor_radius, 180, 0, rad,
+                           color_outline, num_segments,
+                           g_core.outline_tickness);
+    }
+}
+
+void draw::draw(const Triangle &shape, ImU32 color, bool outline,
+                ImU32 color_outline) {
+    if (!shape.m_is_ok) {
+        return;
+    }
+
+    const auto drawlist = g_core.drawlist;
+    for (const auto &tri : {shape.m_top_triangle, shape.m_bottom_triangle}) {
+        if (!tri) {
+            continue;
+        }
+        const auto arr = *tri;
+        drawlist->PathLineTo(to_imvec(arr[0]));
+        drawlist->PathLineTo(to_imvec(arr[1]));
+        drawlist->PathLineTo(to_imvec(arr[2]));
+
+        util::paint(color, outline, color_outline);
+    }
+
+    for (auto &quad : shape.m_quads) {
+        const auto arr = *quad;
+        drawlist->PathLineTo(to_imvec(*arr[0]));
+        drawlist->PathLineTo(to_imvec(*arr[1]));
+        drawlist->PathLineTo(to_imvec(*arr[2]));
+        drawlist->PathLineTo(to_imvec(*arr[3]));
+
+        util::paint(color, outline, color_outline);
+    }
+}
+
+void draw::draw(const Cylinder &shape, ImU32 color, bool outline,
+                ImU32 color_outline) {
+    if (!shape.m_is_ok) {
+        return;
+    }
+
+    const auto drawlist = g_core.drawlist;
+    const auto base_ellipse = shape.m_top_ellipse_base.empty()
+                                  ? &shape.m_bottom_ellipse_base
+                                  : &shape.m_top_ellipse_base;
+    const std::vector<Vector2f *> *face_ellipse1, *face_ellipse2;
+    if (!shape.m_top_ellipse_face.empty()) {
+        face_ellipse1 = &shape.m_top_ellipse_face;
+        face_ellipse2 = &shape.m_bottom_ellipse_face;
+        if (shape.m_top_ellipse_base.empty()) {
+            face_ellipse1 = &shape.m_bottom_ellipse_face;
+            face_ellipse2 = &shape.m_top_ellipse_face;
+        }
+
+        // points repeat at the apex of a cone and where the segments wrap,
+        // those quads are triangles or nothing
+        auto size = face_ellipse1->size();
+        for (size_t i = 0; i < size - 1; i++) {
+            const auto a = (*face_ellipse1)[i];
+            const auto b = (*face_ellipse1)[i + 1];
+            const auto c = (*face_ellipse2)[i + 1];
+            const auto d = (*face_ellipse2)[i];
+            if (a == b && c == d) {
+                continue;
+            }
+            if (a == b) {
+                drawlist->AddTriangleFilled(to_imvec(*a), to_imvec(*c),
+                                            to_imvec(*d), color);
+            } else if (c == d) {
+                drawlist->AddTriangleFilled(to_imvec(*a), to_imvec(*b),
+                                            to_imvec(*c), color);
+            } else {
+                drawlist->AddQuadFilled(to_imvec(*a), to_imvec(*b),
+                                        to_imvec(*c), to_imvec(*d), color);
+            }
+        }
+
+        if (shape.m_is_closed) {
+            // both ellipses are loops, the last two points close them
+            for (const auto face_ellipse : {face_ellipse1, face_ellipse2}) {
+                for (size_t i = 0; i + 2 < face_ellipse->size(); i++) {
+                    drawlist->PathLineToMergeDuplicate(
+                        to_imvec(*(*face_ellipse)[i]));
+                }
+                if (face_ellipse == face_ellipse1 && !base_ellipse->empty()) {
+                    util::paint(color, outline, color_outline);
+                } else if (outline && drawlist->_Path.Size > 1) {
+                    drawlist->AddPolyline(drawlist->_Path.Data,
+                                          drawlist->_Path.Size, color_outline,
+                                          1, g_core.outline_tickness);
+                }
+                drawlist->PathClear();
+            }
+            return;
+        }
+
+        if (outline) {
+            util::path_points(face_ellipse1);
+            util::path_points(face_ellipse2, true);
+            drawlist->AddPolyline(drawlist->_Path.Data, drawlist->_Path.Size,
+                                  color_outline, 1,
+                                  g_core.outline_tickness);
+            drawlist->PathClear();
+        }
+
+        if (!base_ellipse->empty()) {
+            util::path_points(face_ellipse1);
+            util::path_points(base_ellipse);
+            util::paint(color, outline, color_outline, 1,
+                        util::fill_type::convex);
+        }
+    } else {
+        util::path_points(base_ellipse);
+        util::paint(color, outline, color_outline, 0, util::fill_type::convex);
+    }
+}
+
+void draw::draw(const Ring &shape, ImU32 color, bool outline,
+                ImU32 color_outline) {
+    if (!shape.m_is_ok) {
+        return;
+    }
+    const auto drawlist = g_core.drawlist;
+    const std::vector<Vector2f *> *base_ellipse_outer, *base_outer,
+        *base_ellipse_inner, *base_inner, *face_ellipse_outer1,
+        *face_ellipse_outer2, *face_ellipse_inner1, *face_ellipse_inner2;
+    const Vector2f *center;
+
+    if (shape.m_outer_cylinder->m_top_ellipse_base.empty()) {
+        base_ellipse_outer = &shape.m_outer_cylinder->m_bottom_ellipse_base;
+        base_outer = &shape.m_outer_cylinder->m_bottom_base;
+        base_ellipse_inner = &shape.m_inner_cylinder->m_bottom_ellipse_base;
+        base_inner = &shape.m_inner_cylinder->m_bottom_base;
+        center = &shape.m_end2f;
+    } else {
+        base_ellipse_outer = &shape.m_outer_cylinder->m_top_ellipse_base;
+        base_outer = &shape.m_outer_cylinder->m_top_base;
+        base_ellipse_inner = &shape.m_inner_cylinder->m_top_ellipse_base;
+        base_inner = &shape.m_inner_cylinder->m_top_base;
+        center = &shape.m_start2f;
+    }
+
+    if (shape.m_outer_cylinder->m_top_ellipse_base.empty()) {
+        face_ellipse_outer1 = &shape.m_outer_cylinder->m_bottom_ellipse_face;
+        face_ellipse_outer2 = &shape.m_outer_cylinder->m_top_ellipse_face;
+        face_ellipse_inner1 = &shape.m_inner_cylinder->m_bottom_ellipse_face;
+        face_ellipse_inner2 = &shape.m_inner_cylinder->m_top_ellipse_face;
+    } else {
+        face_ellipse_outer1 = &shape.m_outer_cylinder->m_top_ellipse_face;
+        face_ellipse_outer2 = &shape.m_outer_cylinder->m_bottom_ellipse_face;
+        face_ellipse_inner1 = &shape.m_inner_cylinder->m_top_ellipse_face;
+        face_ellipse_inner2 = &shape.m_inner_cylinder->m_bottom_ellipse_face;
+    }
+
+    // inner not visible
+    if (base_ellipse_outer->empty() && base_ellipse_inner->empty()) {
+        draw(*shape.m_outer_cylinder, color, outline, color_outline);
+        return;
+    }
+
+    // fill between inner and outer
+    {
+        const auto size = base_outer->size();
+        for (int i = 0; i <= size - 1; i++) {
+            auto j = i == size - 1 ? 0 : i + 1;
+            drawlist->AddQuadFilled(to_imvec(*(*base_outer)[i]),
+                                    to_imvec(*(*base_outer)[j]),
+                                    to_imvec(*(*base_inner)[j]),
+                                    to_imvec(*(*base_inner)[i]), color);
+        }
+    }
+
+    if (outline) {
+        util::path_points(base_inner);
+        drawlist->AddPolyline(drawlist->_Path.Data, drawlist->_Path.Size,
+                              color_outline, 0,
+                              g_core.outline_tickness);
+        drawlist->PathClear();
+        util::path_points(base_outer);
+        drawlist->AddPolyline(drawlist->_Path.Data, drawlist->_Path.Size,
+                              color_outline, 0,
+                              g_core.outline_tickness);
+        drawlist->PathClear();
+    }
+
+    // fully see through
+    if ((base_inner->size() == face_ellipse_inner1->size()) &&
+        (base_inner->size() == face_ellipse_inner2->size()) &&
+        face_ellipse_outer1->empty()) {
+
+        const auto size = base_inner->size();
+        for (int i = 0; i <= size - 1; i++) {
+            auto j = i == size - 1 ? 0 : i + 1;
+            drawlist->AddQuadFilled(
+                to_imvec(*(*base_inner)[i]), to_imvec(*(*base_inner)[j]),
+                to_imvec(*(*face_ellipse_inner2)[j]),
+                to_imvec(*(*face_ellipse_inner2)[i]), color);
+        }
+
+        if (outline) {
+            util::path_points(face_ellipse_inner2);
+            drawlist->AddPolyline(drawlist->_Path.Data, drawlist->_Path.Size,
+                                  color_outline, 0,
+                                  g_core.outline_tickness);
+            drawlist->PathClear();
+        }
+    }
+    // inner + outer
+    else {
+        // outer
+        if (!face_ellipse_outer1->empty()) {
+            auto size = face_ellipse_outer1->size();
+            for (size_t i = 0; i < size - 1; i++) {
+                drawlist->AddQuadFilled(
+                    to_imvec(*(*face_ellipse_outer1)[i]),
+                    to_imvec(*(*face_ellipse_outer1)[i + 1]),
+                    to_imvec(*(*face_ellipse_outer2)[i + 1]),
+                    to_imvec(*(*face_ellipse_outer2)[i]), color);
+            }
+
+            if (outline) {
+                util::path_points(face_ellipse_outer1);
+                drawlist->PathLineTo(to_imvec(*face_ellipse_outer2->back()));
+                util::path_points(face_ellipse_outer2, true);
+                drawlist->PathLineTo(to_imvec(*(*face_ellipse_outer1)[0]));
+                drawlist->AddPolyline(drawlist->_Path.Data,
+                                      drawlist->_Path.Size, color_outline, 0,
+                                      g_core.outline_tickness);
+                drawlist->PathClear();
+            }
+        }
+
+        // inner
+        std::vector<Vector2f *> face_ellipse_inner2_trim;
+        shape.remove_intersections(*center, *base_inner, *face_ellipse_inner2,
+                                   face_ellipse_inner2_trim);
+
+        if (face_ellipse_inner2_trim.empty()) {
+            util::path_points(base_inner);
+            drawlist->AddConvexPolyFilled(drawlist->_Path.Data,
+                                          drawlist->_Path.Size, color);
+            drawlist->PathClear();
+            return;
+        }
+
+        const size_t idx1 = shape.get_intersection(*face_ellipse_inner2_trim[0],
+                                                   *base_ellipse_inner, true);
+        const size_t idx2 = shape.get_intersection(
+            *face_ellipse_inner2_trim.back(), *base_ellipse_inner);
+
+        util::path_points_duplicate(&face_ellipse_inner2_trim);
+        drawlist->PathLineToMergeDuplicate(
+            to_imvec(*face_ellipse_inner2_trim.back()));
+        drawlist->PathLineTo(to_imvec(*(*base_ellipse_inner)[0]));
+        util::path_points_duplicate(face_ellipse_inner1, true);
+        drawlist->PathLineTo(to_imvec(*base_ellipse_inner->back()));
+        drawlist->AddConcavePolyFilled(drawlist->_Path.Data,
+                                       drawlist->_Path.Size, color);
+        drawlist->PathClear();
+
+        if (outline) {
+            drawlist->AddLine(to_imvec(*(*base_ellipse_inner)[idx1]),
+                              to_imvec(*face_ellipse_inner2_trim[0]),
+                              color_outline);
+            drawlist->AddLine(to_imvec(*(*base_ellipse_inner)[idx2]),
+                              to_imvec(*face_ellipse_inner2_trim.back()),
+                              color_outline);
+            drawlist->PathClear();
+        }
+
+        drawlist->PathLineTo(to_imvec(*face_ellipse_inner2_trim[0]));
+        for (size_t i = idx1; i < base_ellipse_inner->size(); i++) {
+            drawlist->PathLineTo(to_imvec(*(*base_ellipse_inner)[i]));
+        }
+        drawlist->PathLineTo(to_imvec(*face_ellipse_inner2_trim[0]));
+        drawlist->AddConvexPolyFilled(drawlist->_Path.Data,
+                                      drawlist->_Path.Size, color);
+        drawlist->PathClear();
+
+        drawlist->PathLineToMergeDuplicate(
+            to_imvec(*face_ellipse_inner2_trim.back()));
+        for (size_t i = 0; i <= idx2; i++) {
+            drawlist->PathLineTo(to_imvec(*(*base_ellipse_inner)[i]));
+        }
+        drawlist->PathLineToMergeDuplicate(
+            to_imvec(*face_ellipse_inner2_trim.back()));
+        drawlist->AddConvexPolyFilled(drawlist->_Path.Data,
+                                      drawlist->_Path.Size, color);
+        drawlist->PathClear();
+
+        if (outline) {
+            util::path_points(&face_ellipse_inner2_trim);
+            drawlist->AddPolyline(drawlist->_Path.Data, drawlist->_Path.Size,
+                                  color_outline, 0,
+                                  g_core.outline_tickness);
+            drawlist->PathClear();
+        }
+    }
+}
+
+void draw::draw(const Capsule &shape, ImU32 color, bool outline,
+                ImU32 color_outline) {
+    if (!shape.m_is_ok) {
+        return;
+    }
+
+    const auto drawlist = g_core.drawlist;
+
+    if (shape.m_is_sphere) {
+        const auto cap = shape.m_bottom.radius > shape.m_top.radius
+                             ? shape.m_bottom
+                             : shape.m_top;
+        drawlist->AddCircleFilled(to_imvec(cap.center), cap.radius, color);
+        if (outline) {
+            drawlist->AddCircle(to_imvec(cap.center), cap.radius,
+                                color_outline);
+        }
+    } else {
+        drawlist->PathArcTo(to_imvec(shape.m_top.center), shape.m_top.radius,
+                            shape.m_top.a_min, shape.m_top.a_max,
+                            get_num_segments(shape.m_top.radius));
+        drawlist->PathArcTo(to_imvec(shape.m_bottom.center),
+                            shape.m_bottom.radius, shape.m_bottom.a_min,
+                            shape.m_bottom.a_max,
+                            get_num_segments(shape.m_bottom.radius));
+        util::paint(color, outline, color_outline, 1, util::fill_type::convex);
+    }
+}
+
+void draw::draw(const Ellipsoid &shape, ImU32 color, bool outline,
+                ImU32 color_outline) {
+    if (!shape.m_is_ok) {
+        return;
+    }
+    // closed by paint, the last point would repeat the first
+    const auto num_segments =
+        (int)get_num_segments(std::max(shape.m_radii.x, shape.m_radii.y));
+    const auto a_max = glm::radians(360.0f) * (num_segments - 1) / num_segments;
+    g_core.drawlist->PathEllipticalArcTo(to_imvec(shape.m_center),
+                                         to_imvec(shape.m_radii), shape.m_rot,
+                                         0.0f, a_max, num_segments - 1);
+    util::paint(color, outline, color_outline);
+}
+
+void draw::draw(const Hull &shape, ImU32 color, bool outline,
+                ImU32 color_outline) {
+    if (!shape.m_is_ok) {
+        return;
+    }
+
+    const auto drawlist = g_core.drawlist;
+    const auto &mesh = *shape.m_mesh;
+    for (const auto face : shape.m_faces) {
+        for (uint32_t i = 0; i < face->count; i++) {
+            const auto &point = shape.m_points[mesh.indices[face->first + i]];
+            drawlist->PathLineTo(to_imvec(point));
+        }
+        util::paint(color, false, 0);
+    }
+
+    if (!outline) {
+        return;
+    }
+    for (const auto edge : shape.m_edges) {
+        drawlist->AddLine(to_imvec(shape.m_points[edge->a]),
+                          to_imvec(shape.m_points[edge->b]), color_outline,
+                          g_core.outline_tickness);
+    }
+}
+
+void draw::draw(const Trail &shape) {
+    if (!shape.m_is_ok) {
+        return;
+    }
+
+    // two vertices per visible point, a quad between visible neighbours
+    const auto count = shape.m_visible.size();
+    int vtx_count = 0;
+    int idx_count = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (shape.m_visible[i]) {
+            vtx_count += 2;
+            idx_count += i > 0 && shape.m_visible[i - 1] ? 6 : 0;
+        }
+    }
+
+    const auto drawlist = g_core.drawlist;
+    const auto uv = drawlist->_Data->TexUvWhitePixel;
+    drawlist->PrimReserve(idx_count, vtx_count);
+    auto prev = (ImDrawIdx)0;
+    for (size_t i = 0; i < count; i++) {
+        if (!shape.m_visible[i]) {
+            continue;
+        }
+
+        const auto current = (ImDrawIdx)drawlist->_VtxCurrentIdx;
+        const auto color = (ImU32)shape.m_colors[i];
+        drawlist->PrimWriteVtx(to_imvec(shape.m_left[i]), uv, color);
+        drawlist->PrimWriteVtx(to_imvec(shape.m_right[i]), uv, color);
+        if (i > 0 && shape.m_visible[i - 1]) {
+            drawlist->PrimWriteIdx(prev);
+            drawlist->PrimWriteIdx(prev + 1);
+            drawlist->PrimWriteIdx(current + 1);
+            drawlist->PrimWriteIdx(prev);
+            drawlist->PrimWriteIdx(current + 1);
+            drawlist->PrimWriteIdx(current);
+        }
+        prev = current;
+    }
+}
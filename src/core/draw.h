@@ -0,0 +1,197 @@
+#pragma once
+
+#include "imgui.h"
+#include "math_types.h"
+
+#include "shape/shapes.h"
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace draw {
+enum class shape_type {
+    sphere,
+    box,
+    triangle,
+    cylinder,
+    ring,
+    capsule,
+    ellipsoid,
+    cone,
+    hull,
+    trail,
+    // one per batch of lines or arrows
+    lines,
+    // one per batch of labels
+    labels
+};
+// types with a flat record, every type before hull
+constexpr size_t record_type_count = (size_t)shape_type::hull;
+
+// flat record of the matching draw_* arguments in order, matrices are column
+// major, colors are stored as their bit pattern and outline as 0 or 1. hulls
+// reference their mesh and have no record
+constexpr size_t max_record_size = 25;
+size_t record_size(shape_type type);
+void draw_record(shape_type type, const float *record);
+
+// reusable draw settings passed by handle instead of per call
+struct style {
+    ImU32 color{};
+    bool outline{};
+    ImU32 color_outline{};
+    float thickness{1.0f};
+    unsigned num_segments{32};
+    // max distance in pixels between a curve and its segments, 0 always uses
+    // num_segments
+    float lod_tolerance{};
+    // bumped on every change so cached geometry can be invalidated
+    uint64_t version{};
+};
+
+// applies segments, thickness and lod of a style to g_core and
+// restores the previous values when destroyed
+struct scoped_style {
+    explicit scoped_style(const style &style);
+    ~scoped_style();
+    scoped_style(const scoped_style &) = delete;
+    scoped_style &operator=(const scoped_style &) = delete;
+
+  private:
+    unsigned m_num_segments;
+    float m_outline_tickness;
+    float m_lod_tolerance;
+};
+
+void draw_sphere(const Vector3f &center, float radius, ImU32 color,
+                 bool outline, ImU32 color_outline);
+// rotations only use their 3x3 part, orthonormal ones skip the inverse
+void draw_box(const Vector3f &pos, const Vector3f &extent,
+              const Matrix4x4f &rot, ImU32 color, bool outline,
+              ImU32 color_outline);
+void draw_box(const Vector3f &pos, const Vector3f &extent,
+              const Matrix3x3f &rot, ImU32 color, bool outline,
+              ImU32 color_outline);
+void draw_box(const Vector3f &pos, const Vector3f &extent,
+              const glm::quat &rot, ImU32 color, bool outline,
+              ImU32 color_outline);
+void draw_triangle(const Vector3f &pos, const Vector3f &extent,
+                   const Matrix4x4f &rot, ImU32 color, bool outline,
+                   ImU32 color_outline);
+void draw_triangle(const Vector3f &pos, const Vector3f &extent,
+                   const Matrix3x3f &rot, ImU32 color, bool outline,
+                   ImU32 color_outline);
+void draw_triangle(const Vector3f &pos, const Vector3f &extent,
+                   const glm::quat &rot, ImU32 color, bool outline,
+                   ImU32 color_outline);
+void draw_cylinder(const Vector3f &start, const Vector3f &end, float radius,
+                   ImU32 color, bool outline, ImU32 color_outline);
+void draw_ring(const Vector3f &start, const Vector3f &end, float radius_a,
+               float radius_b, ImU32 color, bool outline, ImU32 color_outline);
+void draw_capsule(const Vector3f &start, const Vector3f &end, float radius,
+                  ImU32 color, bool outline, ImU32 color_outline);
+// truncated cone, a radius of 0 makes that end a point
+void draw_cone(const Vector3f &start, const Vector3f &end, float radius_start,
+               float radius_end, ImU32 color, bool outline,
+               ImU32 color_outline);
+// silhouette projected analytically, one filled ellipse
+void draw_ellipsoid(const Vector3f &center, const Vector3f &radii,
+                    const Matrix4x4f &rot, ImU32 color, bool outline,
+                    ImU32 color_outline);
+void draw_ellipsoid(const Vector3f &center, const Vector3f &radii,
+                    const Matrix3x3f &rot, ImU32 color, bool outline,
+                    ImU32 color_outline);
+void draw_ellipsoid(const Vector3f &center, const Vector3f &radii,
+                    const glm::quat &rot, ImU32 color, bool outline,
+                    ImU32 color_outline);
+// front faces filled and only the edges touching them stroked. not recorded
+// into display lists or captures and not cached, retained hulls keep their
+// own mesh
+void draw_hull(const hull::mesh &mesh, const Vector3f &pos,
+               const Matrix3x3f &rot, ImU32 color, bool outline,
+               ImU32 color_outline);
+
+// camera facing ribbon through the history, one strip whose points fade out
+// with age. not recorded or cached either
+void draw_trail(const trail::history &history);
+// segments from points[2 * i] to points[2 * i + 1] in one batch, colors holds
+// one per segment or a single one for all. cut at the near plane, not cached
+// and skipped while a display list is recording
+void draw_lines(std::span<const Vector3f> points,
+                std::span<const ImU32> colors);
+// lines with a head at their end, head_size in pixels and 0 picks the default
+void draw_arrows(std::span<const Vector3f> points,
+                 std::span<const ImU32> colors, float head_size);
+// red, green and blue arrows along the columns of rot
+void draw_axes(const Vector3f &pos, const Matrix3x3f &rot, float size);
+// texts centered on their projected positions, colors as for lines. size is
+// the font size in pixels and 0 picks the current one. glyph runs are cached
+// per string, labels behind the camera or off screen are skipped. skipped
+// while a display list is recording
+void draw_labels(std::span<const Vector3f> positions,
+                 std::span<const std::string_view> texts,
+                 std::span<const ImU32> colors, float size);
+
+// one template transformed once and only translated per position, the
+// projection of all instances runs as one batch
+void draw_sphere_instances(float radius, std::span<const Vector3f> positions,
+                           ImU32 color, bool outline, ImU32 color_outline);
+void draw_box_instances(const Vector3f &extent, const Matrix3x3f &rot,
+                        std::span<const Vector3f> positions, ImU32 color,
+                        bool outline, ImU32 color_outline);
+void draw_triangle_instances(const Vector3f &extent, const Matrix3x3f &rot,
+                             std::span<const Vector3f> positions, ImU32 color,
+                             bool outline, ImU32 color_outline);
+
+void draw(const Box &shape, ImU32 color, bool outline, ImU32 color_outline);
+void draw(const Sphere &shape, ImU32 color, bool outline, ImU32 color_outline);
+void draw(const Triangle &shape, ImU32 color, bool outline,
+          ImU32 color_outline);
+void draw(const Cylinder &shape, ImU32 color, bool outline,
+          ImU32 color_outline);
+void draw(const Ring &shape, ImU32 color, bool outline, ImU32 color_outline);
+void draw(const Capsule &shape, ImU32 color, bool outline, ImU32 color_outline);
+void draw(const Ellipsoid &shape, ImU32 color, bool outline,
+          ImU32 color_outline);
+void draw(const Hull &shape, ImU32 color, bool outline, ImU32 color_outline);
+void draw(const Trail &shape);
+} // namespace draw
+
+namespace draw::util {
+enum class fill_type { convex, concave };
+
+// vertices and indices emitted into the background drawlist, indices are
+// relative to the first captured vertex
+struct mesh {
+    std::vector<ImDrawVert> vtx;
+    std::vector<ImDrawIdx> idx;
+};
+
+struct capture {
+    int vtx_begin;
+    int idx_begin;
+    int cmd_count;
+    unsigned int vtx_offset;
+    unsigned int vtx_current_idx;
+};
+
+capture begin_capture();
+bool end_capture(const capture &capture, mesh &out);
+void replay(const mesh &mesh);
+// replays the mesh of a retained shape unless it is dirty or was projected
+// with another camera, false when the shape has to be drawn again. captures
+// need the record of every shape each frame and only drawing writes it, so
+// nothing is replayed while capturing
+bool replay_retained(const mesh &mesh, bool dirty, uint64_t camera_version);
+void path_points(const std::vector<Vector2f *> *points, bool reverse = false);
+void path_points_duplicate(const std::vector<Vector2f *> *points,
+                           bool reverse = false);
+void draw_ellipse(const ImVec2 &center, float radius_x, float radius_y,
+                  float rot, float a_min, float a_max, ImU32 color,
+                  int num_segments, float thickness, ImDrawFlags flags = 0);
+void paint(ImU32 color, bool outline, ImU32 color_outline,
+           ImDrawFlags stroke_flags = 1,
+           fill_type fill_type = fill_type::convex);
+} // namespace draw::util
@@ -0,0 +1,390 @@
+#include "math_types.h"
+
+#include "hull.h"
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+// triangles are merged into a face when their normal is this close to the
+// one of its first triangle and their points lie this close to its plane,
+// relative to the hull size
+constexpr float coplanar_cos = 0.9999f;
+constexpr float coplanar_distance = 0.0001f;
+constexpr uint32_t none = UINT32_MAX;
+
+struct triangle {
+    std::array<uint32_t, 3> v;
+    Vector3f normal;
+    float offset;
+    // points above the plane, every point is assigned to one triangle only
+    std::vector<uint32_t> outside{};
+    bool removed{};
+};
+
+uint64_t edge_key(uint32_t a, uint32_t b) { return (uint64_t)a << 32 | b; }
+
+struct builder {
+    std::span<const Vector3f> points;
+    float eps{};
+    // distance between the two farthest extremes
+    float size{};
+    std::vector<triangle> triangles{};
+    // directed edge to the triangle it belongs to, the twin of a -> b is the
+    // neighbour across it
+    std::unordered_map<uint64_t, uint32_t> edges{};
+
+    float distance(const triangle &tri, uint32_t i) const {
+        return glm::dot(tri.normal, points[i]) - tri.offset;
+    }
+
+    uint32_t neighbour(uint32_t a, uint32_t b) const {
+        const auto it = edges.find(edge_key(b, a));
+        return it == edges.end() ? none : it->second;
+    }
+
+    uint32_t add(uint32_t a, uint32_t b, uint32_t c) {
+        const auto &pa = points[a];
+        auto normal = glm::cross(points[b] - pa, points[c] - pa);
+        const auto length = glm::length(normal);
+        // slivers never see a point, they only close the surface
+        normal = length > 0.0f ? normal / length : Vector3f{0.0f};
+
+        const auto ret = (uint32_t)triangles.size();
+        triangles.push_back({{a, b, c}, normal, glm::dot(normal, pa)});
+        edges[edge_key(a, b)] = ret;
+        edges[edge_key(b, c)] = ret;
+        edges[edge_key(c, a)] = ret;
+        return ret;
+    }
+
+    // flipped when needed so that inside is below the plane
+    void add_oriented(uint32_t a, uint32_t b, uint32_t c,
+                      const Vector3f &inside) {
+        const auto normal =
+            glm::cross(points[b] - points[a], points[c] - points[a]);
+        if (glm::dot(normal, inside - points[a]) > 0.0f) {
+            std::swap(b, c);
+        }
+        add(a, b, c);
+    }
+
+    void remove(uint32_t i) {
+        auto &tri = triangles[i];
+        tri.removed = true;
+        for (size_t k = 0; k < 3; k++) {
+            edges.erase(edge_key(tri.v[k], tri.v[(k + 1) % 3]));
+        }
+    }
+
+    void assign(uint32_t point, std::span<const uint32_t> candidates) {
+        for (const auto i : candidates) {
+            if (distance(triangles[i], point) > eps) {
+                triangles[i].outside.push_back(point);
+                return;
+            }
+        }
+    }
+
+    bool init();
+    void expand();
+};
+
+bool builder::init() {
+    // extremes along every axis, the farthest pair of them spans the hull
+    std::array<uint32_t, 6> extremes{};
+    Vector3f max_abs{0.0f};
+    for (uint32_t i = 0; i < points.size(); i++) {
+        for (int c = 0; c < 3; c++) {
+            if (points[i][c] < points[extremes[c * 2]][c]) {
+                extremes[c * 2] = i;
+            }
+            if (points[i][c] > points[extremes[c * 2 + 1]][c]) {
+                extremes[c * 2 + 1] = i;
+            }
+            max_abs[c] = std::max(max_abs[c], std::abs(points[i][c]));
+        }
+    }
+    eps = 3.0f * FLT_EPSILON * (max_abs.x + max_abs.y + max_abs.z);
+
+    uint32_t a = 0;
+    uint32_t b = 0;
+    float max_distance = 0.0f;
+    for (const auto i : extremes) {
+        for (const auto j : extremes) {
+            const auto d = glm::distance(points[i], points[j]);
+            if (d > max_distance) {
+                max_distance = d;
+                a = i;
+                b = j;
+            }
+        }
+    }
+    if (max_distance <= eps) {
+        return false;
+    }
+    size = max_distance;
+
+    const auto dir = (points[b] - points[a]) / max_distance;
+    uint32_t c = 0;
+    max_distance = 0.0f;
+    for (uint32_t i = 0; i < points.size(); i++) {
+        const auto d = glm::length(glm::cross(points[i] - points[a], dir));
+        if (d > max_distance) {
+            max_distance = d;
+            c = i;
+        }
+    }
+    if (max_distance <= eps) {
+        return false;
+    }
+
+    const auto normal = glm::normalize(
+        glm::cross(points[b] - points[a], points[c] - points[a]));
+    uint32_t d = 0;
+    max_distance = 0.0f;
+    for (uint32_t i = 0; i < points.size(); i++) {
+        const auto dist = std::abs(glm::dot(normal, points[i] - points[a]));
+        if (dist > max_distance) {
+            max_distance = dist;
+            d = i;
+        }
+    }
+    if (max_distance <= eps) {
+        return false;
+    }
+
+    const auto inside = (points[a] + points[b] + points[c] + points[d]) / 4.0f;
+    add_oriented(a, b, c, inside);
+    add_oriented(a, c, d, inside);
+    add_oriented(a, d, b, inside);
+    add_oriented(b, d, c, inside);
+
+    const std::array<uint32_t, 4> faces{0, 1, 2, 3};
+    for (uint32_t i = 0; i < points.size(); i++) {
+        if (i != a && i != b && i != c && i != d) {
+            assign(i, faces);
+        }
+    }
+    return true;
+}
+
+void builder::expand() {
+    std::vector<uint32_t> visible;
+    std::vector<std::pair<uint32_t, uint32_t>> horizon;
+    std::vector<uint32_t> orphans;
+    std::vector<uint32_t> added;
+    std::vector<uint32_t> visited;
+
+    // triangles appended while expanding are reached by the same loop
+    for (uint32_t t = 0; t < triangles.size(); t++) {
+        if (triangles[t].removed || triangles[t].outside.empty()) {
+            continue;
+        }
+
+        const auto &outside = triangles[t].outside;
+        const auto apex = *std::max_element(
+            outside.begin(), outside.end(), [&](uint32_t a, uint32_t b) {
+                return distance(triangles[t], a) < distance(triangles[t], b);
+            });
+
+        // flood fill of the triangles the apex sees, edges towards the
+        // ones it does not see form the horizon
+        visible.assign(1, t);
+        horizon.clear();
+        visited.resize(triangles.size());
+        visited[t] = t + 1;
+        for (size_t i = 0; i < visible.size(); i++) {
+            const auto v = triangles[visible[i]].v;
+            for (size_t k = 0; k < 3; k++) {
+                const auto a = v[k];
+                const auto b = v[(k + 1) % 3];
+                const auto n = neighbour(a, b);
+                if (n == none) {
+                    continue;
+                }
+                if (visited[n] == t + 1) {
+                    continue;
+                }
+                if (distance(triangles[n], apex) > eps) {
+                    visited[n] = t + 1;
+                    visible.push_back(n);
+                } else {
+                    horizon.emplace_back(a, b);
+                }
+            }
+        }
+
+        orphans.clear();
+        for (const auto i : visible) {
+            auto &tri = triangles[i];
+            orphans.insert(orphans.end(), tri.outside.begin(),
+                           tri.outside.end());
+            tri.outside = {};
+            remove(i);
+        }
+
+        added.clear();
+        for (const auto &[a, b] : horizon) {
+            added.push_back(add(a, b, apex));
+        }
+        for (const auto point : orphans) {
+            if (point != apex) {
+                assign(point, added);
+            }
+        }
+    }
+}
+} // namespace
+
+std::optional<hull::mesh> hull::build(std::span<const Vector3f> points) {
+    if (points.size() < 4) {
+        return std::nullopt;
+    }
+
+    builder builder{points};
+    if (!builder.init()) {
+        return std::nullopt;
+    }
+    builder.expand();
+
+    const auto &triangles = builder.triangles;
+    // coplanar neighbours grouped by flood fill, compared against the first
+    // triangle of the group so a curved surface is not merged into one face
+    std::vector<uint32_t> group(triangles.size(), none);
+    uint32_t group_count = 0;
+    std::vector<uint32_t> stack;
+    for (uint32_t t = 0; t < triangles.size(); t++) {
+        if (triangles[t].removed || group[t] != none) {
+            continue;
+        }
+        const auto &seed = triangles[t];
+        const auto is_coplanar = [&](const triangle &tri) {
+            if (glm::dot(tri.normal, seed.normal) <= coplanar_cos) {
+                return false;
+            }
+            const auto tolerance = builder.size * coplanar_distance;
+            return std::all_of(tri.v.begin(), tri.v.end(), [&](uint32_t i) {
+                return std::abs(builder.distance(seed, i)) <= tolerance;
+            });
+        };
+        group[t] = group_count;
+        stack.assign(1, t);
+        while (!stack.empty()) {
+            const auto i = stack.back();
+            stack.pop_back();
+            const auto &v = triangles[i].v;
+            for (size_t k = 0; k < 3; k++) {
+                const auto n = builder.neighbour(v[k], v[(k + 1) % 3]);
+                if (n == none) {
+                    return std::nullopt;
+                }
+                if (group[n] == none && is_coplanar(triangles[n])) {
+                    group[n] = group_count;
+                    stack.push_back(n);
+                }
+            }
+        }
+        group_count++;
+    }
+
+    // boundary of every group, a -> b in winding order
+    std::vector<std::unordered_map<uint32_t, uint32_t>> boundaries(
+        group_count);
+    std::vector<bool> simple(group_count, true);
+    for (uint32_t t = 0; t < triangles.size(); t++) {
+        if (triangles[t].removed) {
+            continue;
+        }
+        const auto &v = triangles[t].v;
+        for (size_t k = 0; k < 3; k++) {
+            const auto a = v[k];
+            const auto b = v[(k + 1) % 3];
+            if (group[builder.neighbour(a, b)] != group[t] &&
+                !boundaries[group[t]].emplace(a, b).second) {
+                simple[group[t]] = false;
+            }
+        }
+    }
+
+    mesh ret{};
+    std::vector<uint32_t> remap(points.size(), none);
+    const auto push_index = [&](uint32_t i) {
+        if (remap[i] == none) {
+            remap[i] = (uint32_t)ret.vertices.size();
+            ret.vertices.push_back(points[i]);
+        }
+        ret.indices.push_back(remap[i]);
+    };
+
+    // face of every triangle, groups whose boundary is not one loop fall
+    // back to a face per triangle
+    std::vector<uint32_t> face_of(triangles.size(), none);
+    std::vector<uint32_t> group_face(group_count, none);
+    for (uint32_t t = 0; t < triangles.size(); t++) {
+        if (triangles[t].removed) {
+            continue;
+        }
+        const auto g = group[t];
+        const auto &boundary = boundaries[g];
+        if (simple[g] && group_face[g] != none) {
+            face_of[t] = group_face[g];
+            continue;
+        }
+
+        const auto first = (uint32_t)ret.indices.size();
+        if (simple[g]) {
+            auto it = boundary.begin();
+            const auto start = it->first;
+            size_t count = 0;
+            do {
+                push_index(it->first);
+                it = boundary.find(it->second);
+                count++;
+            } while (it != boundary.end() && it->first != start &&
+                     count < boundary.size());
+
+            if (it != boundary.end() && it->first == start &&
+                count == boundary.size()) {
+                group_face[g] = (uint32_t)ret.faces.size();
+                face_of[t] = group_face[g];
+                ret.faces.push_back({first, (uint32_t)count});
+                continue;
+            }
+            ret.indices.resize(first);
+            simple[g] = false;
+        }
+
+        for (const auto i : triangles[t].v) {
+            push_index(i);
+        }
+        face_of[t] = (uint32_t)ret.faces.size();
+        ret.faces.push_back({first, 3});
+    }
+
+    // every edge is seen from both sides, kept from the one where a < b
+    for (uint32_t t = 0; t < triangles.size(); t++) {
+        if (triangles[t].removed) {
+            continue;
+        }
+        const auto &v = triangles[t].v;
+        for (size_t k = 0; k < 3; k++) {
+            const auto a = v[k];
+            const auto b = v[(k + 1) % 3];
+            const auto n = builder.neighbour(a, b);
+            if (a < b && face_of[n] != face_of[t]) {
+                ret.edges.push_back({remap[a], remap[b], face_of[t],
+                                     face_of[n]});
+            }
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "math_types.h"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+// convex hull of a point set, built once so that drawing only has to project
+// its vertices
+namespace hull {
+// polygon of mesh::indices, counter clockwise seen from outside. coplanar
+// triangles are merged so faces of a box stay quads
+struct face {
+    uint32_t first;
+    uint32_t count;
+};
+
+// shared by the two faces on either side
+struct edge {
+    uint32_t a;
+    uint32_t b;
+    uint32_t left;
+    uint32_t right;
+};
+
+struct mesh {
+    // only points on the hull
+    std::vector<Vector3f> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<face> faces;
+    std::vector<edge> edges;
+};
+
+// quickhull, nullopt for fewer than 4 points or when they are all coplanar
+std::optional<mesh> build(std::span<const Vector3f> points);
+} // namespace hull
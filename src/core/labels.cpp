@@ -0,0 +1,233 @@
+#include "imgui.h"
+#include "math_types.h"
+
+#include "core.h"
+#include "display_list.h"
+#include "draw.h"
+#include "labels.h"
+#include "memory.h"
+#include "stats.h"
+#include "shape/util.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+// ImDrawIdx is 16 bit, one reservation can not index more vertices
+constexpr int max_reserved_vertices = 0xFFFF;
+
+// glyph quad at the font's own size, relative to the top left of the run
+struct glyph {
+    Vector2f min;
+    Vector2f max;
+    Vector2f uv_min;
+    Vector2f uv_max;
+};
+
+struct run {
+    std::vector<glyph> glyphs;
+    Vector2f size{};
+    uint64_t last_frame{};
+};
+
+struct string_hash {
+    using is_transparent = void;
+    size_t operator()(std::string_view str) const {
+        return std::hash<std::string_view>{}(str);
+    }
+};
+
+struct run_cache {
+    std::unordered_map<std::string, run, string_hash, std::equal_to<>> runs;
+    // runs are only valid for the font they were laid out with
+    ImFont *font{};
+    uint64_t frame{};
+};
+
+// reused by every batch
+struct scratch {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<Vector2f> screen;
+    std::vector<uint8_t> visible;
+    std::vector<const run *> runs;
+};
+
+run_cache g_cache{};
+
+// next code point of utf-8 text, malformed bytes come out as U+FFFD
+ImWchar decode(std::string_view text, size_t &i) {
+    const auto c = (uint8_t)text[i++];
+    if (c < 0x80) {
+        return c;
+    }
+
+    const auto length = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : 0;
+    if (length == 0 || i + length > text.size()) {
+        return 0xFFFD;
+    }
+    uint32_t ret = c & (0x3F >> length);
+    for (int k = 0; k < length; k++) {
+        const auto next = (uint8_t)text[i];
+        if ((next & 0xC0) != 0x80) {
+            return 0xFFFD;
+        }
+        ret = ret << 6 | (next & 0x3F);
+        i++;
+    }
+    // outside of what ImWchar holds, same as imgui
+    return ret > IM_UNICODE_CODEPOINT_MAX ? 0xFFFD : (ImWchar)ret;
+}
+
+run layout(ImFont &font, std::string_view text) {
+    run ret{};
+    Vector2f pen{0.0f};
+    ret.size.y = font.FontSize;
+    for (size_t i = 0; i < text.size();) {
+        const auto c = decode(text, i);
+        if (c == '\n') {
+            pen = Vector2f{0.0f, pen.y + font.FontSize};
+            ret.size.y += font.FontSize;
+            continue;
+        }
+
+        const auto g = font.FindGlyph(c);
+        if (g == nullptr) {
+            continue;
+        }
+        if (g->Visible) {
+            ret.glyphs.push_back({pen + Vector2f{g->X0, g->Y0},
+                                  pen + Vector2f{g->X1, g->Y1},
+                                  Vector2f{g->U0, g->V0},
+                                  Vector2f{g->U1, g->V1}});
+        }
+        pen.x += g->AdvanceX;
+        ret.size.x = std::max(ret.size.x, pen.x);
+    }
+    return ret;
+}
+
+const run &get_run(ImFont &font, std::string_view text) {
+    if (g_cache.font != &font) {
+        g_cache.runs.clear();
+        g_cache.font = &font;
+    }
+
+    auto it = g_cache.runs.find(text);
+    if (it == g_cache.runs.end()) {
+        it = g_cache.runs.emplace(std::string{text}, layout(font, text)).first;
+    }
+    it->second.last_frame = g_cache.frame;
+    return it->second;
+}
+} // namespace
+
+void draw::draw_labels(std::span<const Vector3f> positions,
+                       std::span<const std::string_view> texts,
+                       std::span<const ImU32> colors, float size) {
+    const auto count = std::min(positions.size(), texts.size());
+    const auto font = ImGui::GetFont();
+    // skipped while recording like lines
+    if (count == 0 || colors.empty() || font == nullptr ||
+        display_list::is_recording()) {
+        return;
+    }
+    stats::shape_scope scope{shape_type::labels};
+    if (scope.m_dropped) {
+        return;
+    }
+    const memory::scope _{memory::subsystem::construct};
+
+    static scratch scratch;
+    scratch.x.resize(count);
+    scratch.y.resize(count);
+    scratch.z.resize(count);
+    scratch.screen.resize(count);
+    scratch.visible.resize(count);
+    scratch.runs.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        scratch.x[i] = positions[i].x;
+        scratch.y[i] = positions[i].y;
+        scratch.z[i] = positions[i].z;
+    }
+    core::world_to_screen(scratch.x.data(), scratch.y.data(),
+                          scratch.z.data(), count, scratch.screen.data(),
+                          scratch.visible.data());
+
+    // labels are centered on their anchor, the ones behind the camera or
+    // entirely off screen are dropped before any glyph is touched
+    const auto scale = (size > 0.0f ? size : ImGui::GetFontSize()) /
+                       font->FontSize;
+    const auto &screen_size = ImGui::GetIO().DisplaySize;
+    int glyph_count = 0;
+    for (size_t i = 0; i < count; i++) {
+        scratch.runs[i] = nullptr;
+        if (!scratch.visible[i]) {
+            continue;
+        }
+
+        const auto &run = get_run(*font, texts[i]);
+        const auto half = run.size * scale * 0.5f;
+        const auto &anchor = scratch.screen[i];
+        if (anchor.x + half.x < 0.0f || anchor.y + half.y < 0.0f ||
+            anchor.x - half.x > screen_size.x ||
+            anchor.y - half.y > screen_size.y) {
+            continue;
+        }
+        scratch.runs[i] = &run;
+        glyph_count += (int)run.glyphs.size();
+    }
+    scope.constructed();
+    if (glyph_count == 0) {
+        return;
+    }
+
+    // reserved in as few chunks as 16 bit indices allow
+    const auto drawlist = g_core.drawlist;
+    const auto chunk_size = max_reserved_vertices / 4;
+    int reserved = 0;
+    for (size_t i = 0; i < count; i++) {
+        const auto run = scratch.runs[i];
+        if (run == nullptr) {
+            continue;
+        }
+
+        const auto color = colors[std::min(i, colors.size() - 1)];
+        // snapped to whole pixels so glyphs stay sharp
+        const auto origin =
+            glm::floor(scratch.screen[i] - run->size * scale * 0.5f);
+        for (const auto &glyph : run->glyphs) {
+            if (reserved == 0) {
+                reserved = std::min(glyph_count, chunk_size);
+                glyph_count -= reserved;
+                drawlist->PrimReserve(reserved * 6, reserved * 4);
+            }
+            reserved--;
+
+            const auto min = origin + glyph.min * scale;
+            const auto max = origin + glyph.max * scale;
+            drawlist->PrimRectUV(to_imvec(min), to_imvec(max),
+                                 to_imvec(glyph.uv_min), to_imvec(glyph.uv_max),
+                                 color);
+        }
+    }
+}
+
+void labels::end_frame() {
+    g_cache.frame++;
+    std::erase_if(g_cache.runs, [](const auto &item) {
+        return g_cache.frame - item.second.last_frame > max_age;
+    });
+}
+
+void labels::clear() {
+    g_cache.runs.clear();
+    g_cache.font = nullptr;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+
+// glyph runs of label strings, laid out once and reused across frames until
+// a string goes unused for a while
+namespace labels {
+// frames a run is kept without being drawn
+constexpr size_t max_age = 120;
+
+// ages the runs and drops the stale ones, called once per rendered frame
+void end_frame();
+// font atlas is gone, every run references its uvs
+void clear();
+} // namespace labels
@@ -0,0 +1,248 @@
+#include "imgui.h"
+#include "math_types.h"
+
+#include "core.h"
+#include "display_list.h"
+#include "draw.h"
+#include "memory.h"
+#include "stats.h"
+#include "shape/util.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace {
+// steps of the search for the last visible point without a screen matrix
+constexpr int clip_steps = 8;
+constexpr float default_head_size = 8.0f;
+// ImDrawIdx is 16 bit, one reservation can not index more vertices
+constexpr int max_reserved_vertices = 0xFFFF;
+
+// screen endpoints of every segment after clipping, reused by every batch
+struct segments {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    // per point, only used without a screen matrix
+    std::vector<uint8_t> points_visible;
+    std::vector<Vector2f> screen;
+    // per segment
+    std::vector<uint8_t> visible;
+    size_t count{};
+};
+
+// near plane of m in clip space, points in front of it have a positive dot
+// product with it. depth is z = a * w + b, b is positive for reversed depth
+// where the near plane is z = w, otherwise it is z = 0 as in d3d
+Vector4f get_near_plane(const Matrix4x4f &m) {
+    const Vector3f w{m[0][3], m[1][3], m[2][3]};
+    const Vector3f z{m[0][2], m[1][2], m[2][2]};
+    const auto length = glm::dot(w, w);
+    // orthographic, w is the same everywhere
+    if (length == 0.0f) {
+        return Vector4f{0.0f, 0.0f, 0.0f, 1.0f};
+    }
+    const auto a = glm::dot(z, w) / length;
+    const auto b = m[3][2] - a * m[3][3];
+    return b > 0.0f ? Vector4f{0.0f, 0.0f, -1.0f, 1.0f}
+                    : Vector4f{0.0f, 0.0f, 1.0f, 0.0f};
+}
+
+// both endpoints of every segment through one matrix product each, the part
+// behind the near plane is cut off in clip space
+void project_matrix(const Matrix4x4f &m, std::span<const Vector3f> points,
+                    segments &out) {
+    const auto near_plane = get_near_plane(m);
+    for (size_t i = 0; i < out.count; i++) {
+        auto a = m * Vector4f{points[i * 2], 1.0f};
+        auto b = m * Vector4f{points[i * 2 + 1], 1.0f};
+        const auto near_a = glm::dot(near_plane, a);
+        const auto near_b = glm::dot(near_plane, b);
+        if (near_a <= 0.0f && near_b <= 0.0f) {
+            out.visible[i] = false;
+            continue;
+        }
+        if (near_a < 0.0f) {
+            a = glm::mix(a, b, near_a / (near_a - near_b));
+        } else if (near_b < 0.0f) {
+            b = glm::mix(b, a, near_b / (near_b - near_a));
+        }
+        out.screen[i * 2] = Vector2f{a.x, a.y} / a.w;
+        out.screen[i * 2 + 1] = Vector2f{b.x, b.y} / b.w;
+        out.visible[i] = true;
+    }
+}
+
+// last point from visible towards hidden that still projects
+Vector2f clip_search(const Vector3f &visible, const Vector3f &hidden,
+                     Vector2f screen) {
+    auto lo = 0.0f;
+    auto hi = 1.0f;
+    for (int i = 0; i < clip_steps; i++) {
+        const auto t = (lo + hi) * 0.5f;
+        if (const auto res =
+                core::world_to_screen(glm::mix(visible, hidden, t))) {
+            screen = *res;
+            lo = t;
+        } else {
+            hi = t;
+        }
+    }
+    return screen;
+}
+
+// projections without a matrix, all points go through one batch and only
+// segments crossing the camera plane are searched
+void project_batch(std::span<const Vector3f> points, segments &out) {
+    const auto count = out.count * 2;
+    out.x.resize(count);
+    out.y.resize(count);
+    out.z.resize(count);
+    out.points_visible.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        out.x[i] = points[i].x;
+        out.y[i] = points[i].y;
+        out.z[i] = points[i].z;
+    }
+    core::world_to_screen(out.x.data(), out.y.data(), out.z.data(), count,
+                          out.screen.data(), out.points_visible.data());
+
+    for (size_t i = 0; i < out.count; i++) {
+        const auto a = out.points_visible[i * 2];
+        const auto b = out.points_visible[i * 2 + 1];
+        out.visible[i] = a || b;
+        if (a && !b) {
+            out.screen[i * 2 + 1] = clip_search(
+                points[i * 2], points[i * 2 + 1], out.screen[i * 2]);
+        } else if (!a && b) {
+            out.screen[i * 2] = clip_search(points[i * 2 + 1], points[i * 2],
+                                            out.screen[i * 2 + 1]);
+        }
+    }
+}
+
+const segments &project(std::span<const Vector3f> points) {
+    static segments ret;
+    ret.count = points.size() / 2;
+    ret.screen.resize(ret.count * 2);
+    ret.visible.resize(ret.count);
+    if (const auto m = g_core.projection->get_screen_matrix()) {
+        project_matrix(*m, points, ret);
+    } else {
+        project_batch(points, ret);
+    }
+    return ret;
+}
+
+// a quad per segment and a triangle per arrow head, reserved in as few
+// chunks as 16 bit indices allow
+void emit(const segments &segments, std::span<const ImU32> colors,
+          float head_size) {
+    const auto is_arrow = head_size > 0.0f;
+    int visible = 0;
+    for (size_t i = 0; i < segments.count; i++) {
+        visible += segments.visible[i];
+    }
+    if (visible == 0) {
+        return;
+    }
+
+    const auto drawlist = g_core.drawlist;
+    const auto uv = drawlist->_Data->TexUvWhitePixel;
+    const auto half_width = g_core.outline_tickness * 0.5f;
+    const auto vertices = is_arrow ? 7 : 4;
+    const auto indices = is_arrow ? 9 : 6;
+    const auto chunk_size = max_reserved_vertices / vertices;
+    int reserved = 0;
+    for (size_t i = 0; i < segments.count; i++) {
+        if (!segments.visible[i]) {
+            continue;
+        }
+        if (reserved == 0) {
+            reserved = std::min(visible, chunk_size);
+            visible -= reserved;
+            drawlist->PrimReserve(reserved * indices, reserved * vertices);
+        }
+        reserved--;
+
+        const auto color = colors[std::min(i, colors.size() - 1)];
+        const auto &a = segments.screen[i * 2];
+        auto b = segments.screen[i * 2 + 1];
+        const auto length = glm::length(b - a);
+        const auto dir =
+            length > 0.0f ? (b - a) / length : Vector2f{1.0f, 0.0f};
+        const Vector2f normal{-dir.y, dir.x};
+
+        const auto idx = (ImDrawIdx)drawlist->_VtxCurrentIdx;
+        if (is_arrow) {
+            // heads of short segments shrink with them
+            const auto head = std::min(head_size, length * 0.5f);
+            const auto tip = b;
+            b -= dir * head;
+            drawlist->PrimWriteVtx(to_imvec(tip), uv, color);
+            const auto left = b + normal * head * 0.5f;
+            const auto right = b - normal * head * 0.5f;
+            drawlist->PrimWriteVtx(to_imvec(left), uv, color);
+            drawlist->PrimWriteVtx(to_imvec(right), uv, color);
+            drawlist->PrimWriteIdx(idx);
+            drawlist->PrimWriteIdx(idx + 1);
+            drawlist->PrimWriteIdx(idx + 2);
+        }
+
+        const auto offset = normal * half_width;
+        const std::array<Vector2f, 4> quad{a + offset, b + offset, b - offset,
+                                           a - offset};
+        const auto first = (ImDrawIdx)drawlist->_VtxCurrentIdx;
+        for (const auto &point : quad) {
+            drawlist->PrimWriteVtx(to_imvec(point), uv, color);
+        }
+        drawlist->PrimWriteIdx(first);
+        drawlist->PrimWriteIdx(first + 1);
+        drawlist->PrimWriteIdx(first + 2);
+        drawlist->PrimWriteIdx(first);
+        drawlist->PrimWriteIdx(first + 2);
+        drawlist->PrimWriteIdx(first + 3);
+    }
+}
+
+void draw_segments(std::span<const Vector3f> points,
+                   std::span<const ImU32> colors, float head_size) {
+    // no record to keep them in, and no frame has been started to draw into
+    if (points.size() < 2 || colors.empty() ||
+        display_list::is_recording()) {
+        return;
+    }
+    stats::shape_scope scope{draw::shape_type::lines};
+    if (scope.m_dropped) {
+        return;
+    }
+    const memory::scope _{memory::subsystem::construct};
+    const auto &segments = project(points);
+    scope.constructed();
+    emit(segments, colors, head_size);
+}
+} // namespace
+
+void draw::draw_lines(std::span<const Vector3f> points,
+                      std::span<const ImU32> colors) {
+    draw_segments(points, colors, 0.0f);
+}
+
+void draw::draw_arrows(std::span<const Vector3f> points,
+                       std::span<const ImU32> colors, float head_size) {
+    draw_segments(points, colors,
+                  head_size > 0.0f ? head_size : default_head_size);
+}
+
+void draw::draw_axes(const Vector3f &pos, const Matrix3x3f &rot, float size) {
+    const std::array<Vector3f, 6> points{pos, pos + rot[0] * size,
+                                         pos, pos + rot[1] * size,
+                                         pos, pos + rot[2] * size};
+    static constexpr std::array<ImU32, 3> colors{
+        IM_COL32(255, 0, 0, 255), IM_COL32(0, 255, 0, 255),
+        IM_COL32(0, 0, 255, 255)};
+    draw_arrows(points, colors, 0.0f);
+}
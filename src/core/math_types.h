@@ -0,0 +1,16 @@
+#pragma once
+
+// same aliases as reframework/Math.hpp without pulling in reframework
+#define GLM_ENABLE_EXPERIMENTAL
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+using Vector2f = glm::vec2;
+using Vector3f = glm::vec3;
+using Vector4f = glm::vec4;
+using Matrix3x3f = glm::mat3x3;
+using Matrix3x4f = glm::mat3x4;
+using Matrix4x4f = glm::mat4x4;
@@ -0,0 +1,82 @@
+#include "imgui.h"
+
+#include "memory.h"
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::array<std::atomic<uint64_t>, memory::subsystem_count> g_allocations{};
+std::array<std::atomic<uint64_t>, memory::subsystem_count> g_bytes{};
+thread_local memory::subsystem g_current{memory::subsystem::other};
+
+void add(memory::subsystem subsystem, size_t bytes) {
+    g_allocations[(size_t)subsystem].fetch_add(1, std::memory_order_relaxed);
+    g_bytes[(size_t)subsystem].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void *imgui_alloc(size_t size, void *) {
+    add(memory::subsystem::drawlist, size);
+    return std::malloc(size);
+}
+
+void imgui_free(void *ptr, void *) { std::free(ptr); }
+
+void *allocate(size_t size) {
+    memory::count(size);
+    return std::malloc(size ? size : 1);
+}
+} // namespace
+
+memory::scope::scope(subsystem subsystem) : m_prev(g_current) {
+    g_current = subsystem;
+}
+
+memory::scope::~scope() { g_current = m_prev; }
+
+void memory::install_imgui() {
+    ImGui::SetAllocatorFunctions(imgui_alloc, imgui_free);
+}
+
+void memory::count(size_t bytes) { add(g_current, bytes); }
+
+memory::counts memory::take() {
+    counts ret{};
+    for (size_t i = 0; i < subsystem_count; i++) {
+        ret.allocations[i] =
+            g_allocations[i].exchange(0, std::memory_order_relaxed);
+        ret.bytes[i] = g_bytes[i].exchange(0, std::memory_order_relaxed);
+    }
+    return ret;
+}
+
+// replaced for the whole module, every allocation goes through count
+void *operator new(size_t size) {
+    if (const auto ret = allocate(size)) {
+        return ret;
+    }
+    throw std::bad_alloc{};
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    return allocate(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+    return allocate(size);
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+    std::free(ptr);
+}
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+    std::free(ptr);
+}
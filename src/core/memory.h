@@ -0,0 +1,38 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// heap allocations made by hb_draw, its own through operator new and imgui's
+// through the allocator functions, attributed to the subsystem in scope
+namespace memory {
+// binding is what the lua wrappers allocate around a draw call once sol2 has
+// converted its arguments, the conversion itself counts as other
+enum class subsystem { other, construct, drawlist, binding };
+constexpr size_t subsystem_count = 4;
+
+struct counts {
+    std::array<uint64_t, subsystem_count> allocations{};
+    std::array<uint64_t, subsystem_count> bytes{};
+};
+
+// attributes what the calling thread allocates while alive, imgui always
+// counts as drawlist
+struct scope {
+    explicit scope(subsystem subsystem);
+    ~scope();
+    scope(const scope &) = delete;
+    scope &operator=(const scope &) = delete;
+
+  private:
+    subsystem m_prev;
+};
+
+// routes imgui through the counters, has to be called before
+// ImGui::CreateContext
+void install_imgui();
+void count(size_t bytes);
+// counted since the previous call
+counts take();
+} // namespace memory
@@ -0,0 +1,150 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+struct event {
+    const char *name;
+    int64_t start;
+    int64_t end;
+};
+
+// single writer, the owning thread. readers copy it and drop whatever could
+// have been overwritten while copying
+struct ring {
+    uint32_t tid;
+    std::array<event, profiler::ring_size> events;
+    // events written so far, the next one goes to count % ring_size
+    std::atomic<uint64_t> count{};
+};
+
+const auto g_epoch = std::chrono::steady_clock::now();
+
+// rings outlive their threads so a trace can still show them
+std::mutex g_rings_mutex;
+std::vector<std::unique_ptr<ring>> g_rings;
+
+// frame ends, only touched from the present thread
+std::array<int64_t, profiler::frame_history_size> g_frames{};
+uint64_t g_frame_count{};
+// zones older than this were cleared
+int64_t g_cleared{};
+
+int64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - g_epoch)
+        .count();
+}
+
+ring &get_ring() {
+    thread_local ring *ret{};
+    if (ret == nullptr) {
+        std::lock_guard _{g_rings_mutex};
+        ret = g_rings.emplace_back(std::make_unique<ring>()).get();
+        ret->tid = (uint32_t)g_rings.size();
+    }
+    return *ret;
+}
+
+void copy_events(const ring &ring, int64_t since, std::vector<event> &out) {
+    const auto count = ring.count.load(std::memory_order_acquire);
+    const auto first = count > profiler::ring_size
+                           ? count - profiler::ring_size
+                           : 0;
+    const auto begin = out.size();
+    for (auto i = first; i < count; i++) {
+        out.push_back(ring.events[i % profiler::ring_size]);
+    }
+
+    // the writer kept going while copying, slots it reached may be torn,
+    // including the one it may be writing right now
+    const auto after = ring.count.load(std::memory_order_acquire);
+    const auto intact = after + 1 > profiler::ring_size
+                            ? after + 1 - profiler::ring_size
+                            : 0;
+    const auto torn = intact > first ? std::min(intact - first, count - first)
+                                     : 0;
+    out.erase(out.begin() + begin, out.begin() + begin + torn);
+    std::erase_if(out, [&](const event &event) {
+        return event.end < since;
+    });
+}
+} // namespace
+
+profiler::zone::zone(const char *name) : m_name(name), m_start(now()) {}
+
+profiler::zone::~zone() {
+    auto &ring = get_ring();
+    const auto count = ring.count.load(std::memory_order_relaxed);
+    ring.events[count % ring_size] = {m_name, m_start, now()};
+    ring.count.store(count + 1, std::memory_order_release);
+}
+
+void profiler::end_frame() {
+    g_frames[g_frame_count % frame_history_size] = now();
+    g_frame_count++;
+}
+
+bool profiler::dump_trace(const char *path, size_t frames) {
+    frames = std::min({frames, (size_t)g_frame_count, frame_history_size - 1});
+    // end of the frame before the first one dumped
+    auto since = g_cleared;
+    if (frames < g_frame_count) {
+        since = std::max(
+            since,
+            g_frames[(g_frame_count - frames - 1) % frame_history_size]);
+    }
+
+    const auto file = std::fopen(path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+
+    std::fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    std::fprintf(file, "{\"name\": \"process_name\", \"ph\": \"M\", "
+                       "\"pid\": 1, \"args\": {\"name\": \"hb_draw\"}}");
+    for (auto i = g_frame_count - frames; i < g_frame_count; i++) {
+        std::fprintf(file,
+                     ",\n{\"name\": \"frame\", \"ph\": \"i\", \"s\": \"g\", "
+                     "\"pid\": 1, \"tid\": 0, \"ts\": %.3f}",
+                     g_frames[i % frame_history_size] / 1000.0);
+    }
+
+    std::vector<event> events;
+    std::lock_guard _{g_rings_mutex};
+    for (const auto &ring : g_rings) {
+        std::fprintf(file,
+                     ",\n{\"name\": \"thread_name\", \"ph\": \"M\", "
+                     "\"pid\": 1, \"tid\": %u, "
+                     "\"args\": {\"name\": \"thread %u\"}}",
+                     ring->tid, ring->tid);
+
+        events.clear();
+        copy_events(*ring, since, events);
+        std::sort(events.begin(), events.end(),
+                  [](const event &a, const event &b) {
+                      return a.start < b.start;
+                  });
+        for (const auto &event : events) {
+            std::fprintf(file,
+                         ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, "
+                         "\"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}",
+                         event.name, ring->tid, event.start / 1000.0,
+                         (event.end - event.start) / 1000.0);
+        }
+    }
+    std::fprintf(file, "\n]}\n");
+    return std::fclose(file) == 0;
+}
+
+void profiler::clear() {
+    g_frame_count = 0;
+    g_cleared = now();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// scoped timing zones, compiled in with HB_DRAW_PROFILE. zones are recorded
+// into a ring owned by the thread that closes them, so recording takes no
+// lock
+namespace profiler {
+#ifdef HB_DRAW_PROFILE
+constexpr bool enabled = true;
+#else
+constexpr bool enabled = false;
+#endif
+
+// events kept per thread, older ones are overwritten
+constexpr size_t ring_size = 1 << 16;
+// frame boundaries kept, bounds how far back a trace can reach
+constexpr size_t frame_history_size = 600;
+
+struct zone {
+    // name has to outlive the trace, string literals only
+    explicit zone(const char *name);
+    ~zone();
+    zone(const zone &) = delete;
+    zone &operator=(const zone &) = delete;
+
+  private:
+    const char *m_name;
+    int64_t m_start;
+};
+
+// marks the end of a frame, called once per present
+void end_frame();
+// writes the zones of the last frames as a chrome/perfetto json trace,
+// false when the file can not be written
+bool dump_trace(const char *path, size_t frames);
+void clear();
+} // namespace profiler
+
+#define HB_DRAW_CONCAT_(a, b) a##b
+#define HB_DRAW_CONCAT(a, b) HB_DRAW_CONCAT_(a, b)
+
+#ifdef HB_DRAW_PROFILE
+#define HB_DRAW_ZONE(name)                                                     \
+    const profiler::zone HB_DRAW_CONCAT(hb_draw_zone_, __COUNTER__) { name }
+#else
+#define HB_DRAW_ZONE(name)
+#endif
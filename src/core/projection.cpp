@@ -0,0 +1,75 @@
+#include "projection.h"
+
+#include <optional>
+
+void projection::world_to_screen(const float *x, const float *y,
+                                 const float *z, size_t count, Vector2f *out,
+                                 uint8_t *visible) {
+    for (size_t i = 0; i < count; i++) {
+        const auto screen_pos = world_to_screen(Vector3f{x[i], y[i], z[i]});
+        visible[i] = screen_pos.has_value();
+        if (screen_pos) {
+            out[i] = *screen_pos;
+        }
+    }
+}
+
+std::optional<Vector2f>
+matrix_projection::world_to_screen(const Vector3f &pos) {
+    return project(pos);
+}
+
+void matrix_projection::world_to_screen(const float *x, const float *y,
+                                        const float *z, size_t count,
+                                        Vector2f *out, uint8_t *visible) {
+    project(x, y, z, count, out, visible);
+}
+
+std::optional<Vector2f>
+matrix_projection::project(const Vector3f &pos) const {
+    Vector2f out{};
+    uint8_t visible{};
+    project(&pos.x, &pos.y, &pos.z, 1, &out, &visible);
+    if (!visible) {
+        return std::nullopt;
+    }
+    return out;
+}
+
+void matrix_projection::project(const float *x, const float *y,
+                                const float *z, size_t count, Vector2f *out,
+                                uint8_t *visible) const {
+    // clip space to a top left origin
+    const Matrix4x4f m = proj * view;
+    const auto width = screen_size.x;
+    const auto height = screen_size.y;
+
+    // branchless so the loop vectorizes
+    for (size_t i = 0; i < count; i++) {
+        // forward points behind the camera
+        const auto facing = (x[i] - origin.x) * -forward.x +
+                            (y[i] - origin.y) * -forward.y +
+                            (z[i] - origin.z) * -forward.z;
+        const auto clip_x =
+            m[0][0] * x[i] + m[1][0] * y[i] + m[2][0] * z[i] + m[3][0];
+        const auto clip_y =
+            m[0][1] * x[i] + m[1][1] * y[i] + m[2][1] * z[i] + m[3][1];
+        const auto clip_w =
+            m[0][3] * x[i] + m[1][3] * y[i] + m[2][3] * z[i] + m[3][3];
+        const auto inv_w = 1.0f / clip_w;
+
+        out[i].x = (clip_x * inv_w * 0.5f + 0.5f) * width;
+        out[i].y = (0.5f - clip_y * inv_w * 0.5f) * height;
+        visible[i] = facing > 0.0f && clip_w > 0.0f;
+    }
+}
+
+std::optional<Matrix4x4f> matrix_projection::get_screen_matrix() const {
+    // clip space to a top left origin, same as world_to_screen
+    Matrix4x4f viewport{1.0f};
+    viewport[0][0] = screen_size.x * 0.5f;
+    viewport[1][1] = -screen_size.y * 0.5f;
+    viewport[3][0] = screen_size.x * 0.5f;
+    viewport[3][1] = screen_size.y * 0.5f;
+    return viewport * proj * view;
+}
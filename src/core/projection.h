@@ -0,0 +1,50 @@
+#pragma once
+
+#include "math_types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+// world to screen mapping the shapes are projected through
+struct projection {
+    virtual ~projection() = default;
+
+    // nullopt when behind the camera
+    virtual std::optional<Vector2f> world_to_screen(const Vector3f &pos) = 0;
+    // count points given as separate component arrays, out[i] is only valid
+    // where visible[i] is set. defaults to one world_to_screen per point
+    virtual void world_to_screen(const float *x, const float *y,
+                                 const float *z, size_t count, Vector2f *out,
+                                 uint8_t *visible);
+    // camera up, screen radii are measured along it
+    virtual Vector3f get_up() const = 0;
+    // world to pixels as one matrix, x and y of the result divided by its w.
+    // nullopt when points are not projected through a matrix
+    virtual std::optional<Matrix4x4f> get_screen_matrix() const {
+        return std::nullopt;
+    }
+};
+
+// proj * view applied directly, what via.math worldPos2ScreenPos computes
+struct matrix_projection : projection {
+    std::optional<Vector2f> world_to_screen(const Vector3f &pos) override;
+    void world_to_screen(const float *x, const float *y, const float *z,
+                         size_t count, Vector2f *out,
+                         uint8_t *visible) override;
+    Vector3f get_up() const override { return up; }
+    std::optional<Matrix4x4f> get_screen_matrix() const override;
+
+    // the matrix kernel both world_to_screen overloads run, never dispatched
+    // to a subclass, so it can be checked against an override
+    std::optional<Vector2f> project(const Vector3f &pos) const;
+    void project(const float *x, const float *y, const float *z, size_t count,
+                 Vector2f *out, uint8_t *visible) const;
+
+    Matrix4x4f view{1.0f};
+    Matrix4x4f proj{1.0f};
+    Vector3f origin{};
+    Vector3f forward{0.0f, 0.0f, 1.0f};
+    Vector3f up{0.0f, 1.0f, 0.0f};
+    Vector2f screen_size{};
+};
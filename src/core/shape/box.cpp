@@ -1,28 +1,27 @@
-#include "reframework/Math.hpp"
+#include "math_types.h"
 
+#include "profiler.h"
 #include "shapes.h"
 #include "util.h"
 
 #include <array>
 #include <vector>
 
-Box::Box(const Vector3f &pos, const Vector3f &extent, const Matrix4x4f &rot) {
-    const std::array<Vector4f, 8> corners4f = {
-        Vector4f(extent, 0) * -1.0f,
-        Vector4f(extent.x, -extent.y, -extent.z, 0),
-        Vector4f(extent.x, extent.y, -extent.z, 0),
-        Vector4f(-extent.x, extent.y, -extent.z, 0),
-        Vector4f(-extent.x, extent.y, extent.z, 0),
-        Vector4f(-extent.x, -extent.y, extent.z, 0),
-        Vector4f(extent.x, -extent.y, extent.z, 0),
-        Vector4f(extent, 0)};
-
-    auto opt = get_screen_corners(corners4f, rot, pos);
+Box::Box(const Vector3f &pos, const Vector3f &extent,
+         const Matrix3x3f &basis) {
+    HB_DRAW_ZONE("Box::Box");
+    const auto corners = transform_points(pos, extent, basis, sx, sy, sz);
+    auto opt = get_screen_points(corners);
     if (!opt) {
         return;
     }
+    set_points(*opt);
+}
+
+Box::Box(const std::array<Vector2f, 8> &points) { set_points(points); }
 
-    m_points = std::move(*opt);
+void Box::set_points(const std::array<Vector2f, 8> &points) {
+    m_points = points;
     m_quads_p = {{
         {&m_points[0], &m_points[1], &m_points[2], &m_points[3]},
         {&m_points[0], &m_points[3], &m_points[4], &m_points[5]},
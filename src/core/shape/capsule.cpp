@@ -1,9 +1,11 @@
-#include "reframework/Math.hpp"
+#include "math_types.h"
 
+#include "profiler.h"
 #include "shapes.h"
 #include "util.h"
 
 Capsule::Capsule(const Vector3f &start, const Vector3f &end, float radius) {
+    HB_DRAW_ZONE("Capsule::Capsule");
     const auto top_screen_radius = get_screen_radius(start, radius);
     const auto bottom_screen_radius = get_screen_radius(end, radius);
 
@@ -1,35 +1,78 @@
-#include "reframework/Math.hpp"
+#include "math_types.h"
 
-#include "plugin.h"
+#include "core.h"
+#include "profiler.h"
 #include "shapes.h"
 #include "util.h"
 
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <unordered_map>
+
+namespace {
+// cos and sin of every segment, shared by both ends and by every cylinder with
+// the same segment count
+const std::vector<Vector2f> *get_unit_circle(unsigned num_segments) {
+    static std::unordered_map<unsigned, std::vector<Vector2f>> tables;
+    auto &ret = tables[num_segments];
+    if (ret.empty()) {
+        const auto increment = glm::radians(360.0f) / num_segments;
+        ret.resize(num_segments);
+        for (unsigned i = 0; i < num_segments; i++) {
+            ret[i] = {std::cos(increment * i), std::sin(increment * i)};
+        }
+    }
+    return &ret;
+}
+} // namespace
 
 Cylinder::Cylinder(const Vector3f &start, const Vector3f &end, float radius,
-                   float rot, bool is_hollow)
-    : m_rot(rot), m_is_hollow(is_hollow) {
-    m_angle_increment = glm::radians(360.0f) / g_hbdraw.imgui.num_segments;
-    m_top_points.resize(g_hbdraw.imgui.num_segments);
-    m_bottom_points.resize(g_hbdraw.imgui.num_segments);
+                   float rot, bool is_hollow, unsigned num_segments)
+    : Cylinder(start, end, radius, radius, rot, is_hollow, num_segments) {}
+
+Cylinder::Cylinder(const Vector3f &start, const Vector3f &end,
+                   float radius_start, float radius_end, float rot,
+                   bool is_hollow, unsigned num_segments)
+    : m_radius_start(radius_start), m_radius_end(radius_end),
+      m_is_hollow(is_hollow) {
+    HB_DRAW_ZONE("Cylinder::Cylinder");
+    if (radius_start == 0.0f && radius_end == 0.0f) {
+        return;
+    }
+    // the wider end decides the lod
+    if (!num_segments) {
+        num_segments =
+            std::abs(radius_start) >= std::abs(radius_end)
+                ? get_num_segments(start, std::abs(radius_start))
+                : get_num_segments(end, std::abs(radius_end));
+    }
+    // faces are tested two segments at a time
+    m_num_segments = std::max(4u, num_segments + (num_segments & 1));
+    m_unit_circle = get_unit_circle(m_num_segments);
+    m_top_points.resize(m_num_segments);
+    m_bottom_points.resize(m_num_segments);
 
     const auto dir = glm::normalize(end - start);
-    m_up = glm::cross(dir, Vector3f(0, 1, 0));
+    auto up = glm::cross(dir, Vector3f(0, 1, 0));
 
-    if (glm::length(m_up) < 0.0001f) {
-        m_up = glm::cross(dir, Vector3f(1, 0, 0));
+    if (glm::length(up) < 0.0001f) {
+        up = glm::cross(dir, Vector3f(1, 0, 0));
     }
 
-    m_right = glm::cross(m_up, dir);
-    m_up = glm::normalize(m_up) * radius;
-    m_right = glm::normalize(m_right) * radius;
+    const auto right = glm::normalize(glm::cross(up, dir));
+    up = glm::normalize(up);
+    // the rotation is folded into the axes so the table stays unrotated
+    m_right = right * std::cos(rot) + up * std::sin(rot);
+    m_up = up * std::cos(rot) - right * std::sin(rot);
 
-    const size_t base_max_i = g_hbdraw.imgui.num_segments / 2;
+    const size_t base_max_i = m_num_segments / 2;
     size_t face_begin = 0;
     size_t base_begin = 0;
     std::array<Vector2f *, 4> out;
     size_t j = 0;
     size_t i = 0;
+    bool is_closed = true;
 
     auto insert_base = [&](std::vector<Vector2f *> &partial_base,
                            std::vector<Vector2f *> &full_base) {
@@ -51,8 +94,8 @@ Cylinder::Cylinder(const Vector3f &start, const Vector3f &end, float radius,
         base_begin = 0;
     };
 
-    for (i = 0; i <= g_hbdraw.imgui.num_segments; i += 2) {
-        i = i == g_hbdraw.imgui.num_segments ? i - 1 : i;
+    for (i = 0; i <= m_num_segments; i += 2) {
+        i = i == m_num_segments ? i - 1 : i;
         j = i <= base_max_i ? i + base_max_i : i - base_max_i;
 
         result top_res, bottom_res = result::miss;
@@ -109,6 +152,30 @@ Cylinder::Cylinder(const Vector3f &start, const Vector3f &end, float radius,
             base_begin = 0;
             face_begin = 0;
         }
+        if (top_res != result::hit && bottom_res != result::hit) {
+            is_closed = false;
+        }
+    }
+
+    // every side face is visible, only a cone seen past its narrow end gets
+    // here and no base was tested on the way. the face ellipses are full
+    // loops from segment 0, the narrow cap is the one that can be visible
+    if (is_closed && m_top_ellipse_base.empty() &&
+        m_bottom_ellipse_base.empty()) {
+        m_is_closed = true;
+        const auto &top = m_top_points;
+        const auto &bottom = m_bottom_points;
+        const auto k = m_num_segments / 2;
+        if (radius_start != 0.0f && is_frontface(*top[0], *top[1], *top[k])) {
+            m_top_ellipse_base.assign(m_top_ellipse_face.begin(),
+                                      m_top_ellipse_face.begin() +
+                                          m_num_segments);
+        } else if (radius_end != 0.0f &&
+                   is_frontface(*bottom[k], *bottom[1], *bottom[0])) {
+            m_bottom_ellipse_base.assign(m_bottom_ellipse_face.begin(),
+                                         m_bottom_ellipse_face.begin() +
+                                             m_num_segments);
+        }
     }
     m_is_ok = true;
 }
@@ -122,11 +189,17 @@ Cylinder::result Cylinder::get_top_face(const Vector3f &start,
         !(m_points[2] = get_point(start, m_top_points, segment))) {
         return result::none;
     }
-    if ((!m_is_hollow &&
-         is_frontface(*m_points[0], *m_points[1], *m_points[2])) ||
-        (m_is_hollow &&
-         is_frontface(*m_points[2], *m_points[1], *m_points[0]))) {
-        if (!(m_points[3] = get_point(end, m_bottom_points, segment + 1))) {
+    // an apex at start collapses this half of the quad, the other half
+    // faces the same way
+    const auto is_apex = m_radius_start == 0.0f;
+    if (is_apex &&
+        !(m_points[3] = get_point(end, m_bottom_points, segment + 1))) {
+        return result::none;
+    }
+    if (is_face_front(*m_points[0], *m_points[is_apex ? 3 : 1],
+                      *m_points[2])) {
+        if (!is_apex &&
+            !(m_points[3] = get_point(end, m_bottom_points, segment + 1))) {
             return result::none;
         }
         out[0] = m_points[2];
@@ -141,6 +214,10 @@ Cylinder::result Cylinder::get_top_base(const Vector3f &start,
                                         const Vector3f &end,
                                         std::array<Vector2f *, 4> &out,
                                         size_t segment) {
+    // an apex has no base
+    if (m_radius_start == 0.0f) {
+        return result::miss;
+    }
     if (!(m_points[4] = get_point(start, m_top_points, segment))) {
         return result::none;
     }
@@ -161,11 +238,16 @@ Cylinder::result Cylinder::get_bottom_face(const Vector3f &start,
         !(m_points[2] = get_point(start, m_top_points, segment))) {
         return result::none;
     }
-    if (((!m_is_hollow &&
-          is_frontface(*m_points[0], *m_points[1], *m_points[2])) ||
-         (m_is_hollow &&
-          is_frontface(*m_points[2], *m_points[1], *m_points[0])))) {
-        if (!(m_points[3] = get_point(start, m_top_points, segment + 1))) {
+    // same as get_top_face, with the apex at end
+    const auto is_apex = m_radius_end == 0.0f;
+    if (is_apex &&
+        !(m_points[3] = get_point(start, m_top_points, segment + 1))) {
+        return result::none;
+    }
+    if (is_face_front(*m_points[0], *m_points[is_apex ? 3 : 1],
+                      *m_points[2])) {
+        if (!is_apex &&
+            !(m_points[3] = get_point(start, m_top_points, segment + 1))) {
             return result::none;
         }
         out[0] = m_points[2];
@@ -181,6 +263,9 @@ Cylinder::result Cylinder::get_bottom_base(const Vector3f &start,
                                            const Vector3f &end,
                                            std::array<Vector2f *, 4> &out,
                                            size_t segment) {
+    if (m_radius_end == 0.0f) {
+        return result::miss;
+    }
     if (!(m_points[4] = get_point(end, m_bottom_points, segment))) {
         return result::none;
     }
@@ -192,10 +277,18 @@ Cylinder::result Cylinder::get_bottom_base(const Vector3f &start,
     return result::miss;
 }
 
+bool Cylinder::is_face_front(const Vector2f &a, const Vector2f &b,
+                             const Vector2f &c) const {
+    return m_is_hollow ? is_frontface(c, b, a) : is_frontface(a, b, c);
+}
+
 Vector2f *Cylinder::get_point(const Vector3f &pos,
                               std::vector<std::optional<Vector2f>> &cache,
                               size_t segment) {
-    if (segment == g_hbdraw.imgui.num_segments) {
+    const auto radius =
+        &cache == &m_top_points ? m_radius_start : m_radius_end;
+    // an apex is projected once for every segment
+    if (segment == m_num_segments || radius == 0.0f) {
         segment = 0;
     }
 
@@ -203,9 +296,9 @@ Vector2f *Cylinder::get_point(const Vector3f &pos,
         return &*cache[segment];
     }
 
-    const float angle = m_rot + m_angle_increment * segment;
-    cache[segment] = scene::world_to_screen(pos + m_right * std::cos(angle) +
-                                            m_up * std::sin(angle));
+    const auto &unit = (*m_unit_circle)[segment];
+    const auto offset = (m_right * unit.x + m_up * unit.y) * radius;
+    cache[segment] = core::world_to_screen(pos + offset);
 
     if (!cache[segment]) {
         return nullptr;
@@ -0,0 +1,92 @@
+#include "math_types.h"
+
+#include "core.h"
+#include "profiler.h"
+#include "shapes.h"
+#include "util.h"
+
+#include <array>
+#include <cmath>
+
+namespace {
+// outline of the points x where (x - center)^T e^-1 (x - center) = 1, e is
+// symmetric so only e00, e01 and e11 are passed
+bool set_ellipse(Ellipsoid &out, const Vector2f &center, double e00,
+                 double e01, double e11) {
+    const auto mean = (e00 + e11) * 0.5;
+    const auto root = std::sqrt((e00 - e11) * (e00 - e11) * 0.25 + e01 * e01);
+    const auto minor = mean - root;
+    if (!(minor > 0.0) || !is_point_ok(center)) {
+        return false;
+    }
+    out.m_center = center;
+    out.m_radii = {(float)std::sqrt(mean + root), (float)std::sqrt(minor)};
+    out.m_rot = (float)(0.5 * std::atan2(2.0 * e01, e00 - e11));
+    return true;
+}
+} // namespace
+
+Ellipsoid::Ellipsoid(const Vector3f &center, const Vector3f &radii,
+                     const Matrix3x3f &basis) {
+    HB_DRAW_ZONE("Ellipsoid::Ellipsoid");
+    const std::array<Vector3f, 3> axes = {
+        basis[0] * radii.x, basis[1] * radii.y, basis[2] * radii.z};
+
+    const auto screen = g_core.projection->get_screen_matrix();
+    if (!screen) {
+        // parallel projection of the axes around the projected center
+        const auto points = get_screen_points(std::array<Vector3f, 4>{
+            center, center + axes[0], center + axes[1], center + axes[2]});
+        if (!points) {
+            return;
+        }
+        double e00 = 0.0;
+        double e01 = 0.0;
+        double e11 = 0.0;
+        for (size_t i = 1; i < 4; i++) {
+            const auto axis = (*points)[i] - (*points)[0];
+            e00 += (double)axis.x * axis.x;
+            e01 += (double)axis.x * axis.y;
+            e11 += (double)axis.y * axis.y;
+        }
+        m_is_ok = set_ellipse(*this, (*points)[0], e00, e01, e11);
+        return;
+    }
+
+    // the unit sphere's dual quadric diag(1, 1, 1, -1) moved by the axes and
+    // center, then projected: dual = b * diag(1, 1, 1, -1) * b^T with b the
+    // x, y and w rows of screen * [axes | center]
+    const auto &m = *screen;
+    std::array<std::array<double, 4>, 3> b{};
+    constexpr std::array<int, 3> rows = {0, 1, 3};
+    for (size_t r = 0; r < 3; r++) {
+        const auto row = rows[r];
+        for (size_t i = 0; i < 3; i++) {
+            b[r][i] = (double)m[0][row] * axes[i].x +
+                      (double)m[1][row] * axes[i].y +
+                      (double)m[2][row] * axes[i].z;
+        }
+        b[r][3] = (double)m[0][row] * center.x + (double)m[1][row] * center.y +
+                  (double)m[2][row] * center.z + m[3][row];
+    }
+
+    std::array<std::array<double, 3>, 3> dual{};
+    for (size_t j = 0; j < 3; j++) {
+        for (size_t k = j; k < 3; k++) {
+            dual[j][k] = b[j][0] * b[k][0] + b[j][1] * b[k][1] +
+                         b[j][2] * b[k][2] - b[j][3] * b[k][3];
+        }
+    }
+
+    // only an ellipsoid fully in front of the camera plane projects to an
+    // ellipse, dual[2][2] < 0 keeps it on one side and w > 0 in front
+    const auto w = -dual[2][2];
+    if (!(w > 0.0) || b[2][3] <= 0.0) {
+        return;
+    }
+    const auto cx = -dual[0][2] / w;
+    const auto cy = -dual[1][2] / w;
+    m_is_ok = set_ellipse(*this, Vector2f{(float)cx, (float)cy},
+                          dual[0][0] / w + cx * cx, dual[0][1] / w + cx * cy,
+                          dual[1][1] / w + cy * cy);
+}
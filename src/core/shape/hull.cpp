@@ -0,0 +1,80 @@
+#include "math_types.h"
+
+#include "core.h"
+#include "hull.h"
+#include "profiler.h"
+#include "shapes.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+// reused by every hull, world points are projected as one batch
+struct scratch {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<uint8_t> visible;
+    std::vector<uint8_t> front;
+};
+
+// twice the signed screen area, faces counter clockwise seen from outside
+// come out negative when they face the camera
+float get_area(const std::vector<Vector2f> &points, const hull::mesh &mesh,
+               const hull::face &face) {
+    const auto &origin = points[mesh.indices[face.first]];
+    float ret = 0.0f;
+    for (uint32_t i = 1; i + 1 < face.count; i++) {
+        const auto a = points[mesh.indices[face.first + i]] - origin;
+        const auto b = points[mesh.indices[face.first + i + 1]] - origin;
+        ret += a.x * b.y - a.y * b.x;
+    }
+    return ret;
+}
+} // namespace
+
+Hull::Hull(const hull::mesh &mesh, const Vector3f &pos,
+           const Matrix3x3f &rot)
+    : m_mesh(&mesh) {
+    HB_DRAW_ZONE("Hull::Hull");
+    static scratch scratch;
+    const auto count = mesh.vertices.size();
+    scratch.x.resize(count);
+    scratch.y.resize(count);
+    scratch.z.resize(count);
+    scratch.visible.resize(count);
+    m_points.resize(count);
+
+    for (size_t i = 0; i < count; i++) {
+        const auto point = pos + rot * mesh.vertices[i];
+        scratch.x[i] = point.x;
+        scratch.y[i] = point.y;
+        scratch.z[i] = point.z;
+    }
+    core::world_to_screen(scratch.x.data(), scratch.y.data(),
+                          scratch.z.data(), count, m_points.data(),
+                          scratch.visible.data());
+    for (const auto visible : scratch.visible) {
+        if (!visible) {
+            return;
+        }
+    }
+
+    // mirroring transforms flip the winding
+    const auto sign = glm::determinant(rot) < 0.0f ? -1.0f : 1.0f;
+    auto &front = scratch.front;
+    front.resize(mesh.faces.size());
+    for (size_t i = 0; i < mesh.faces.size(); i++) {
+        front[i] = get_area(m_points, mesh, mesh.faces[i]) * sign < 0.0f;
+        if (front[i]) {
+            m_faces.push_back(&mesh.faces[i]);
+        }
+    }
+    for (const auto &edge : mesh.edges) {
+        if (front[edge.left] || front[edge.right]) {
+            m_edges.push_back(&edge);
+        }
+    }
+
+    m_is_ok = !m_faces.empty();
+}
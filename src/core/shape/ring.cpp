@@ -1,34 +1,39 @@
 
-#include "reframework/Math.hpp"
+#include "math_types.h"
 
-#include "scene.h"
+#include "core.h"
+#include "profiler.h"
 #include "shapes.h"
 #include "util.h"
 
 Ring::Ring(const Vector3f &start, const Vector3f &end, float radius_a,
            float radius_b) {
+    HB_DRAW_ZONE("Ring::Ring");
     radius_b = radius_b - radius_a;
 
-    auto center2f = scene::world_to_screen(start);
+    auto center2f = core::world_to_screen(start);
     if (!center2f) {
         return;
     }
     m_start2f = *center2f;
 
-    center2f = scene::world_to_screen(end);
+    center2f = core::world_to_screen(end);
     if (!center2f) {
         return;
     }
     m_end2f = *center2f;
 
-    m_outer_cylinder =
-        std::make_unique<Cylinder>(Cylinder(start, end, radius_a));
+    // both cylinders have to share the segment count, the fill pairs their
+    // points up
+    const auto num_segments = get_num_segments(start, radius_a);
+    m_outer_cylinder = std::make_unique<Cylinder>(
+        Cylinder(start, end, radius_a, 0.0f, false, num_segments));
     if (!m_outer_cylinder->m_is_ok) {
         return;
     }
 
-    m_inner_cylinder = std::make_unique<Cylinder>(
-        Cylinder(start, end, radius_b, glm::radians(180.0f), true));
+    m_inner_cylinder = std::make_unique<Cylinder>(Cylinder(
+        start, end, radius_b, glm::radians(180.0f), true, num_segments));
     if (!m_inner_cylinder->m_is_ok) {
         return;
     }
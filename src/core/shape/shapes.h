@@ -1,6 +1,10 @@
-#include "reframework/Math.hpp"
+#include "math_types.h"
+
+#include "hull.h"
+#include "trail.h"
 
 #include <array>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -11,31 +15,48 @@ struct Shape {
 
 struct Sphere : Shape {
     Sphere(const Vector3f &center, float radius);
+    // already projected
+    Sphere(const Vector2f &center, float radius);
     float m_radius;
     Vector2f m_center;
 };
 
 struct Box : Shape {
-    Box(const Vector3f &pos, const Vector3f &extent, const Matrix4x4f &rot);
+    // basis columns are the world axes, see get_basis
+    Box(const Vector3f &pos, const Vector3f &extent, const Matrix3x3f &basis);
+    // corner signs along the basis axes
+    static constexpr std::array<float, 8> sx = {-1, 1, 1, -1, -1, -1, 1, 1};
+    static constexpr std::array<float, 8> sy = {-1, -1, 1, 1, 1, -1, -1, 1};
+    static constexpr std::array<float, 8> sz = {-1, -1, -1, -1, 1, 1, 1, 1};
+    // already projected corners in the order of the constructor above
+    explicit Box(const std::array<Vector2f, 8> &points);
     std::vector<std::array<Vector2f *, 4> *> m_quads;
 
   private:
+    void set_points(const std::array<Vector2f, 8> &points);
+
     std::array<Vector2f, 8> m_points;
     std::array<std::array<Vector2f *, 4>, 6> m_quads_p;
 };
 
 struct Triangle : Shape {
     Triangle(const Vector3f &pos, const Vector3f &extent,
-             const Matrix4x4f &rot);
+             const Matrix3x3f &basis);
+    // corner signs along the basis axes, top triangle followed by the bottom
+    // one
+    static constexpr std::array<float, 6> sx = {1, -1, 0, 0, -1, 1};
+    static constexpr std::array<float, 6> sy = {1, 1, 1, -1, -1, -1};
+    static constexpr std::array<float, 6> sz = {1, 1, -1, -1, 1, 1};
+    // already projected, top triangle followed by the bottom one
+    explicit Triangle(const std::array<Vector2f, 6> &points);
     std::array<Vector2f, 3> *m_top_triangle = nullptr;
     std::array<Vector2f, 3> *m_bottom_triangle = nullptr;
     std::vector<std::array<Vector2f *, 4> *> m_quads;
 
   private:
-    bool get_triangle(const Vector3f &pos, const Matrix4x4f &rot,
-                      const std::array<Vector4f, 3> &triangle3f,
-                      std::array<Vector2f, 3> &corners2f,
-                      std::array<Vector2f, 3> *&culled);
+    void set_points(const std::array<Vector2f, 6> &points);
+    void cull(std::array<Vector2f, 3> &corners2f,
+              std::array<Vector2f, 3> *&culled);
 
     std::array<Vector2f, 3> m_top_points;
     std::array<Vector2f, 3> m_bottom_points;
@@ -43,8 +64,14 @@ struct Triangle : Shape {
 };
 
 struct Cylinder : Shape {
+    // num_segments 0 picks the count from g_core and the lod
     Cylinder(const Vector3f &start, const Vector3f &end, float radius,
-             float rot = 0.0f, bool is_hollow = false);
+             float rot = 0.0f, bool is_hollow = false,
+             unsigned num_segments = 0);
+    // truncated cone, either radius can be 0 for a pointed end
+    Cylinder(const Vector3f &start, const Vector3f &end, float radius_start,
+             float radius_end, float rot, bool is_hollow,
+             unsigned num_segments);
 
     std::vector<Vector2f *> m_top_ellipse_base;
     std::vector<Vector2f *> m_bottom_ellipse_base;
@@ -52,9 +79,14 @@ struct Cylinder : Shape {
     std::vector<Vector2f *> m_bottom_ellipse_face;
     std::vector<Vector2f *> m_top_base;
     std::vector<Vector2f *> m_bottom_base;
+    // every side face is visible, the face ellipses are full loops and the
+    // visible cap, if any, is the whole base ellipse
+    bool m_is_closed = false;
 
   private:
     enum result { none = 0, hit = 1, miss = 2 };
+    bool is_face_front(const Vector2f &a, const Vector2f &b,
+                       const Vector2f &c) const;
     Vector2f *get_point(const Vector3f &pos,
                         std::vector<std::optional<Vector2f>> &cache,
                         size_t segment);
@@ -67,11 +99,14 @@ struct Cylinder : Shape {
     result get_bottom_base(const Vector3f &start, const Vector3f &end,
                            std::array<Vector2f *, 4> &out, size_t segment);
 
-    float m_rot;
+    float m_radius_start;
+    float m_radius_end;
+    // unit length, scaled by the radius of each end
     Vector3f m_up;
     Vector3f m_right;
-    float m_angle_increment;
     bool m_is_hollow;
+    unsigned m_num_segments{};
+    const std::vector<Vector2f> *m_unit_circle{};
     std::array<Vector2f *, 5> m_points;
     std::vector<std::optional<Vector2f>> m_top_points;
     std::vector<std::optional<Vector2f>> m_bottom_points;
@@ -110,3 +145,36 @@ struct Capsule : Shape {
     std::array<Vector2f, 4> m_quad;
     bool m_is_sphere = false;
 };
+
+struct Ellipsoid : Shape {
+    // basis columns are the world axes, see get_basis
+    Ellipsoid(const Vector3f &center, const Vector3f &radii,
+              const Matrix3x3f &basis);
+
+    Vector2f m_center;
+    Vector2f m_radii;
+    // of the first radius
+    float m_rot;
+};
+
+struct Hull : Shape {
+    // vertices are placed at pos + rot * vertex
+    Hull(const hull::mesh &mesh, const Vector3f &pos, const Matrix3x3f &rot);
+
+    const hull::mesh *m_mesh;
+    // one per hull vertex, projected in one batch
+    std::vector<Vector2f> m_points;
+    std::vector<const hull::face *> m_faces;
+    // silhouette and the edges between two front faces
+    std::vector<const hull::edge *> m_edges;
+};
+
+struct Trail : Shape {
+    explicit Trail(const trail::history &history);
+
+    // ribbon edges and faded color of every point, oldest first
+    std::vector<Vector2f> m_left;
+    std::vector<Vector2f> m_right;
+    std::vector<uint32_t> m_colors;
+    std::vector<uint8_t> m_visible;
+};
@@ -1,13 +1,20 @@
-#include "reframework/Math.hpp"
+#include "math_types.h"
 
+#include "profiler.h"
 #include "shapes.h"
 #include "util.h"
 
 Sphere::Sphere(const Vector3f &center, float radius) {
+    HB_DRAW_ZONE("Sphere::Sphere");
     auto opt = get_screen_radius(center, radius);
     if (opt) {
         m_radius = opt->first;
         m_center = opt->second;
         m_is_ok = true;
     }
-}
\ No newline at end of file
+}
+
+Sphere::Sphere(const Vector2f &center, float radius)
+    : m_radius(radius), m_center(center) {
+    m_is_ok = true;
+}
@@ -0,0 +1,93 @@
+#include "math_types.h"
+
+#include "core.h"
+#include "profiler.h"
+#include "shapes.h"
+#include "trail.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+// reused by every trail, each point is projected together with a point half
+// its width above it in one batch
+struct scratch {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<Vector2f> points;
+    std::vector<uint8_t> visible;
+};
+
+// newest point keeps the pushed alpha, older ones fade out linearly
+uint32_t fade(uint32_t color, size_t i, size_t count) {
+    const auto alpha = (color >> 24) * (uint32_t)(i + 1) / (uint32_t)count;
+    return (color & 0x00FFFFFF) | alpha << 24;
+}
+} // namespace
+
+Trail::Trail(const trail::history &history) {
+    HB_DRAW_ZONE("Trail::Trail");
+    const auto count = history.size();
+    if (count < 2) {
+        return;
+    }
+
+    static scratch scratch;
+    scratch.x.resize(count * 2);
+    scratch.y.resize(count * 2);
+    scratch.z.resize(count * 2);
+    scratch.points.resize(count * 2);
+    scratch.visible.resize(count * 2);
+
+    // same top point as get_screen_radius
+    const auto up = glm::normalize(g_core.projection->get_up());
+    for (size_t i = 0; i < count; i++) {
+        const auto &point = history[i];
+        const auto top = point.pos + up * (point.width * 0.5f);
+        scratch.x[i * 2] = point.pos.x;
+        scratch.y[i * 2] = point.pos.y;
+        scratch.z[i * 2] = point.pos.z;
+        scratch.x[i * 2 + 1] = top.x;
+        scratch.y[i * 2 + 1] = top.y;
+        scratch.z[i * 2 + 1] = top.z;
+    }
+    core::world_to_screen(scratch.x.data(), scratch.y.data(),
+                          scratch.z.data(), count * 2, scratch.points.data(),
+                          scratch.visible.data());
+
+    m_left.resize(count);
+    m_right.resize(count);
+    m_colors.resize(count);
+    m_visible.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        m_visible[i] = scratch.visible[i * 2] && scratch.visible[i * 2 + 1];
+    }
+
+    // the ribbon is widened across the screen direction of the path, taken
+    // from the visible neighbours. stationary points keep the last normal
+    Vector2f normal{0.0f, 1.0f};
+    for (size_t i = 0; i < count; i++) {
+        if (!m_visible[i]) {
+            continue;
+        }
+
+        const auto &center = scratch.points[i * 2];
+        const auto prev = i > 0 && m_visible[i - 1] ? i - 1 : i;
+        const auto next = i + 1 < count && m_visible[i + 1] ? i + 1 : i;
+        const auto dir = scratch.points[next * 2] - scratch.points[prev * 2];
+        const auto length = glm::length(dir);
+        if (length > 0.0001f) {
+            normal = Vector2f{-dir.y, dir.x} / length;
+        }
+
+        const auto half_width =
+            glm::length(scratch.points[i * 2 + 1] - center);
+        m_left[i] = center + normal * half_width;
+        m_right[i] = center - normal * half_width;
+        m_colors[i] = fade(history[i].color, i, count);
+        if (i > 0 && m_visible[i - 1]) {
+            m_is_ok = true;
+        }
+    }
+}
@@ -1,29 +1,33 @@
-#include "reframework/Math.hpp"
+#include "math_types.h"
 
+#include "profiler.h"
 #include "shapes.h"
 #include "util.h"
 
+#include <algorithm>
 #include <array>
 #include <vector>
 
 Triangle::Triangle(const Vector3f &pos, const Vector3f &extent,
-                   const Matrix4x4f &rot) {
-    const std::array<Vector4f, 3> top_tri = {
-        Vector4f(extent, 0),
-        Vector4f(-extent.x, extent.y, extent.z, 0),
-        Vector4f(0, extent.y, -extent.z, 0),
-    };
-    const std::array<Vector4f, 3> bottom_tri = {
-        Vector4f(0, -extent.y, -extent.z, 0),
-        Vector4f(-extent.x, -extent.y, extent.z, 0),
-        Vector4f(extent.x, -extent.y, extent.z, 0),
-    };
-
-    if (!get_triangle(pos, rot, top_tri, m_top_points, m_top_triangle) ||
-        !get_triangle(pos, rot, bottom_tri, m_bottom_points,
-                      m_bottom_triangle)) {
+                   const Matrix3x3f &basis) {
+    HB_DRAW_ZONE("Triangle::Triangle");
+    const auto corners = transform_points(pos, extent, basis, sx, sy, sz);
+    auto opt = get_screen_points(corners);
+    if (!opt) {
         return;
-    };
+    }
+    set_points(*opt);
+}
+
+Triangle::Triangle(const std::array<Vector2f, 6> &points) {
+    set_points(points);
+}
+
+void Triangle::set_points(const std::array<Vector2f, 6> &points) {
+    std::copy_n(points.begin(), 3, m_top_points.begin());
+    std::copy_n(points.begin() + 3, 3, m_bottom_points.begin());
+    cull(m_top_points, m_top_triangle);
+    cull(m_bottom_points, m_bottom_triangle);
 
     m_quads_p = {
         {
@@ -58,17 +62,9 @@ Triangle::Triangle(const Vector3f &pos, const Vector3f &extent,
     m_is_ok = (!m_top_triangle && !m_top_triangle) || !m_quads.empty();
 }
 
-bool Triangle::get_triangle(const Vector3f &pos, const Matrix4x4f &rot,
-                            const std::array<Vector4f, 3> &triangle4f,
-                            std::array<Vector2f, 3> &corners2f,
-                            std::array<Vector2f, 3> *&culled) {
-    auto opt = get_screen_corners(triangle4f, rot, pos);
-    if (!opt) {
-        return false;
-    }
-    corners2f = std::move(*opt);
+void Triangle::cull(std::array<Vector2f, 3> &corners2f,
+                    std::array<Vector2f, 3> *&culled) {
     if (is_frontface(corners2f[2], corners2f[0], corners2f[1])) {
         culled = &corners2f;
     }
-    return true;
-}
\ No newline at end of file
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "math_types.h"
+
+#include "core.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <optional>
+
+// copied instead of cast, a read through *(ImVec2 *)& of glm storage breaks
+// strict aliasing and gcc drops the stores it depends on
+inline ImVec2 to_imvec(const Vector2f &v) { return {v.x, v.y}; }
+
+inline bool is_frontface(const Vector2f &a, const Vector2f &b,
+                         const Vector2f &c) {
+    const auto d1 = c - a;
+    const auto d2 = c - b;
+    return (d1.x * d2.y) - (d1.y * d2.x) > 0;
+}
+
+inline std::optional<std::pair<float, Vector2f>>
+get_screen_radius(const Vector3f &pos, float radius) {
+    const auto screen_pos_center = core::world_to_screen(pos);
+    if (screen_pos_center) {
+        const auto pos_top =
+            pos + (glm::normalize(g_core.projection->get_up()) * radius);
+        const auto screen_pos_top = core::world_to_screen(pos_top);
+
+        if (screen_pos_top) {
+            const auto radius2d =
+                glm::length(*screen_pos_top - *screen_pos_center);
+
+            return std::pair(radius2d, *screen_pos_center);
+        }
+    }
+
+    return std::nullopt;
+}
+
+// lod never goes below this even for tiny circles, min_segments closes a
+// curve but 3 or 4 segments read as a triangle or a square, not a circle
+constexpr unsigned min_lod_segments = 8;
+
+// fewest segments that keep a circle of the given screen radius within
+// lod_tolerance pixels, capped at num_segments and kept even for cylinders
+inline unsigned get_num_segments(float radius) {
+    const auto max_segments = g_core.num_segments;
+    const auto tolerance = g_core.lod_tolerance;
+    if (tolerance <= 0.0f) {
+        return max_segments;
+    }
+    if (radius <= tolerance) {
+        return std::min(min_lod_segments, max_segments);
+    }
+
+    auto num = (unsigned)std::ceil(glm::radians(180.0f) /
+                                   std::acos(1.0f - tolerance / radius));
+    num += num & 1;
+    return std::clamp(num, std::min(min_lod_segments, max_segments),
+                      max_segments);
+}
+
+inline unsigned get_num_segments(const Vector3f &pos, float radius) {
+    if (g_core.lod_tolerance <= 0.0f) {
+        return g_core.num_segments;
+    }
+    const auto screen_radius = get_screen_radius(pos, radius);
+    if (!screen_radius) {
+        return g_core.num_segments;
+    }
+    return get_num_segments(screen_radius->first);
+}
+
+inline bool is_orthonormal(const Matrix3x3f &rot) {
+    constexpr float eps = 0.001f;
+    for (int i = 0; i < 3; i++) {
+        for (int j = i; j < 3; j++) {
+            const auto expected = i == j ? 1.0f : 0.0f;
+            if (std::abs(glm::dot(rot[i], rot[j]) - expected) > eps) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// columns are the world axes of the shape, game rotations are orthonormal so
+// the inverse transpose is the rotation itself
+inline Matrix3x3f get_basis(const Matrix3x3f &rot) {
+    if (is_orthonormal(rot)) {
+        return rot;
+    }
+    return glm::transpose(glm::inverse(rot));
+}
+
+// pos + basis * (signs[i] * extent) for every point, components are computed
+// in separate fixed size loops so they vectorize
+template <size_t S>
+std::array<Vector3f, S> transform_points(const Vector3f &pos,
+                                         const Vector3f &extent,
+                                         const Matrix3x3f &basis,
+                                         const std::array<float, S> &sx,
+                                         const std::array<float, S> &sy,
+                                         const std::array<float, S> &sz) {
+    const Vector3f ax = basis[0] * extent.x;
+    const Vector3f ay = basis[1] * extent.y;
+    const Vector3f az = basis[2] * extent.z;
+
+    std::array<Vector3f, S> ret;
+    for (int c = 0; c < 3; c++) {
+        for (size_t i = 0; i < S; i++) {
+            ret[i][c] = pos[c] + sx[i] * ax[c] + sy[i] * ay[c] + sz[i] * az[c];
+        }
+    }
+    return ret;
+}
+
+template <size_t S>
+std::optional<std::array<Vector2f, S>>
+get_screen_points(const std::array<Vector3f, S> &points) {
+    std::array<Vector2f, S> ret;
+    for (size_t i = 0; i < S; i++) {
+        auto opt = core::world_to_screen(points[i]);
+
+        if (!opt) {
+            return std::nullopt;
+        }
+        ret[i] = std::move(*opt);
+    }
+
+    return ret;
+}
+
+inline bool intersect(const Vector2f &p1, const Vector2f &p2,
+                      const Vector2f &q1, const Vector2f &q2) {
+    return (((q1.x - p1.x) * (p2.y - p1.y) - (q1.y - p1.y) * (p2.x - p1.x)) *
+                ((q2.x - p1.x) * (p2.y - p1.y) -
+                 (q2.y - p1.y) * (p2.x - p1.x)) <
+            0) &&
+           (((p1.x - q1.x) * (q2.y - q1.y) - (p1.y - q1.y) * (q2.x - q1.x)) *
+                ((p2.x - q1.x) * (q2.y - q1.y) -
+                 (p2.y - q1.y) * (q2.x - q1.x)) <
+            0);
+}
+
+inline bool is_point_ok(const Vector2f p) {
+    return std::abs(p.x) < 10000 && std::abs(p.y) < 10000;
+}
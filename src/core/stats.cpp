@@ -0,0 +1,260 @@
+#include "imgui.h"
+
+#include "core.h"
+#include "memory.h"
+#include "stats.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+stats::frame stats::g_frame{};
+
+namespace {
+std::array<stats::frame, stats::history_size> g_history{};
+// next slot to write
+size_t g_history_head{};
+size_t g_history_count{};
+
+struct string_hash {
+    using is_transparent = void;
+    size_t operator()(std::string_view str) const {
+        return std::hash<std::string_view>{}(str);
+    }
+};
+
+stats::script_map g_scripts;
+// keyed by the whole chunk source, long lua strings are not interned so
+// their address can be reused by another chunk. looked up without a copy,
+// the name is only built once
+std::unordered_map<std::string, stats::script *, string_hash, std::equal_to<>>
+    g_sources;
+
+stats::script *g_current{};
+bool g_budgeted{};
+unsigned g_depth{};
+
+double to_us(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+std::string to_script_name(std::string_view source) {
+    if (!source.empty() && (source[0] == '@' || source[0] == '=')) {
+        source.remove_prefix(1);
+    }
+
+    for (const auto dir : {"autorun/", "autorun\\"}) {
+        const auto pos = source.rfind(dir);
+        if (pos != std::string_view::npos) {
+            return std::string(source.substr(pos + 8));
+        }
+    }
+    return std::string(source);
+}
+
+bool over_budget(const stats::script &script) {
+    if (script.budget == 0) {
+        return false;
+    }
+    return script.kept >= script.budget || script.priority < script.cutoff;
+}
+
+void count_priority(stats::script &script) {
+    auto &priorities = script.priorities;
+    auto it = std::lower_bound(
+        priorities.begin(), priorities.end(), script.priority,
+        [](const auto &entry, int priority) { return entry.first < priority; });
+    if (it == priorities.end() || it->first != script.priority) {
+        it = priorities.insert(it, {script.priority, 0});
+    }
+    it->second++;
+}
+} // namespace
+
+stats::script *stats::get_script(const std::string &name) {
+    auto &script = g_scripts[name];
+    if (!script) {
+        script = std::make_unique<stats::script>();
+        script->name = name;
+        script->priorities.reserve(8);
+    }
+    return script.get();
+}
+
+stats::script *stats::get_script(const char *source) {
+    const std::string_view key{source};
+    const auto it = g_sources.find(key);
+    if (it != g_sources.end()) {
+        return it->second;
+    }
+    return g_sources.emplace(key, get_script(to_script_name(key)))
+        .first->second;
+}
+
+const stats::script_map &stats::get_scripts() { return g_scripts; }
+
+const stats::frame *stats::get_history(size_t n) {
+    if (n >= g_history_count) {
+        return nullptr;
+    }
+    return &g_history[(g_history_head + history_size - 1 - n) % history_size];
+}
+
+stats::scope::scope(script *script, bool budgeted)
+    : m_prev_script(g_current), m_prev_budgeted(g_budgeted) {
+    g_current = script;
+    g_budgeted = budgeted;
+}
+
+stats::scope::~scope() {
+    g_current = m_prev_script;
+    g_budgeted = m_prev_budgeted;
+}
+
+stats::shape_scope::shape_scope(draw::shape_type type) {
+    if (g_depth++ > 0) {
+        m_nested = true;
+        return;
+    }
+
+    if (g_current) {
+        auto &script = *g_current;
+        script.frame.submitted++;
+        if (g_budgeted) {
+            count_priority(script);
+            if (over_budget(script)) {
+                script.frame.dropped++;
+                m_dropped = true;
+                return;
+            }
+            script.kept++;
+        }
+    }
+
+    g_frame.shapes[(size_t)type]++;
+    m_vtx_begin = g_core.drawlist->VtxBuffer.Size;
+    m_start = std::chrono::steady_clock::now();
+}
+
+void stats::shape_scope::constructed() {
+    if (!m_nested && !m_dropped) {
+        m_constructed = std::chrono::steady_clock::now();
+    }
+}
+
+stats::shape_scope::~shape_scope() {
+    g_depth--;
+    if (m_nested || m_dropped) {
+        return;
+    }
+
+    // culled shapes return before constructed
+    const auto end = std::chrono::steady_clock::now();
+    const auto constructed =
+        m_constructed == std::chrono::steady_clock::time_point{}
+            ? end
+            : m_constructed;
+    g_frame.construct_us += to_us(constructed - m_start);
+    g_frame.emit_us += to_us(end - constructed);
+
+    const auto vertices = g_core.drawlist->VtxBuffer.Size - m_vtx_begin;
+    if (vertices <= 0) {
+        g_frame.culled++;
+    }
+
+    if (g_current == nullptr) {
+        return;
+    }
+    auto &frame = g_current->frame;
+    frame.us += to_us(end - m_start);
+    if (vertices > 0) {
+        frame.drawn++;
+        frame.vertices += vertices;
+    } else {
+        frame.culled++;
+    }
+}
+
+void stats::add_replayed(size_t vertices) {
+    g_frame.replayed++;
+    if (g_current == nullptr) {
+        return;
+    }
+
+    auto &frame = g_current->frame;
+    frame.submitted++;
+    if (vertices > 0) {
+        frame.drawn++;
+        frame.vertices += vertices;
+    } else {
+        frame.culled++;
+    }
+}
+
+void stats::end_frame(std::chrono::steady_clock::time_point render_start) {
+    // drawlist buffers stay valid until the next NewFrame
+    const auto drawlist = g_core.drawlist;
+    if (drawlist) {
+        g_frame.vertices = drawlist->VtxBuffer.Size;
+        g_frame.indices = drawlist->IdxBuffer.Size;
+    }
+    g_frame.render_us = to_us(std::chrono::steady_clock::now() - render_start);
+    const auto counts = memory::take();
+    g_frame.allocations = counts.allocations;
+    g_frame.allocated_bytes = counts.bytes;
+
+    g_history[g_history_head] = g_frame;
+    g_history_head = (g_history_head + 1) % history_size;
+    g_history_count = std::min(g_history_count + 1, history_size);
+    g_frame = {};
+
+    for (auto &[_, script] : g_scripts) {
+        script->last = script->frame;
+        script->frame = {};
+        script->kept = 0;
+
+        uint64_t submitted = 0;
+        for (const auto &[_, count] : script->priorities) {
+            submitted += count;
+        }
+
+        // keeps the highest priorities that fit, the highest one is always
+        // kept
+        script->cutoff = INT_MIN;
+        if (script->budget > 0 && submitted > script->budget) {
+            uint64_t total = 0;
+            for (auto it = script->priorities.rbegin();
+                 it != script->priorities.rend(); it++) {
+                total += it->second;
+                if (total > script->budget &&
+                    it != script->priorities.rbegin()) {
+                    break;
+                }
+                script->cutoff = it->first;
+            }
+        }
+        // drops priorities that were not used this frame, the capacity stays
+        std::erase_if(script->priorities,
+                      [](const auto &entry) { return entry.second == 0; });
+        for (auto &[_, count] : script->priorities) {
+            count = 0;
+        }
+    }
+}
+
+void stats::clear() {
+    g_history_head = 0;
+    g_history_count = 0;
+    g_frame = {};
+    // drops what was counted before the clear
+    memory::take();
+    g_sources.clear();
+    g_scripts.clear();
+    g_current = nullptr;
+}
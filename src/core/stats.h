@@ -0,0 +1,122 @@
+#pragma once
+
+#include "draw.h"
+#include "memory.h"
+
+#include <array>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace stats {
+constexpr size_t history_size = 300;
+
+// totals of one frame over every script
+struct frame {
+    std::array<uint64_t, 12> shapes{};
+    uint64_t culled{};
+    uint64_t replayed{};
+    // world_to_screen calls, each one a managed call too
+    uint64_t projections{};
+    uint64_t managed_calls{};
+    uint64_t vertices{};
+    uint64_t indices{};
+    uint64_t cache_hits{};
+    uint64_t cache_misses{};
+    uint64_t cache_entries{};
+    // heap allocations and their bytes per memory::subsystem
+    std::array<uint64_t, memory::subsystem_count> allocations{};
+    std::array<uint64_t, memory::subsystem_count> allocated_bytes{};
+    double camera_us{};
+    double construct_us{};
+    double emit_us{};
+    double render_us{};
+};
+
+// frame being built, counted into directly from the hot paths
+extern frame g_frame;
+
+struct counters {
+    uint64_t submitted{};
+    uint64_t culled{};
+    uint64_t drawn{};
+    // skipped because the script went over its budget
+    uint64_t dropped{};
+    uint64_t vertices{};
+    // projection and tessellation
+    double us{};
+};
+
+struct script {
+    std::string name;
+    counters frame{};
+    // last finished frame, what get_stats reports
+    counters last{};
+    // applied to everything the script submits after set_priority
+    int priority{};
+    // max shapes per frame, 0 is unlimited
+    uint64_t budget{};
+    // shapes below are dropped this frame, picked from last frame's
+    // submissions so that the budget holds
+    int cutoff{INT_MIN};
+    // budgeted shapes submitted this frame per priority, sorted by priority.
+    // entries are kept across frames so a steady set of priorities does not
+    // allocate
+    std::vector<std::pair<int, uint64_t>> priorities{};
+    uint64_t kept{};
+};
+
+using script_map = std::unordered_map<std::string, std::unique_ptr<script>>;
+
+// creates the script on first use
+script *get_script(const std::string &name);
+// script of a lua chunk source, the name is only built once per source
+script *get_script(const char *source);
+const script_map &get_scripts();
+// finished frame n frames back, 0 is the newest, nullptr past the history
+const frame *get_history(size_t n);
+
+// attributes the shapes drawn while alive to a script, budgets are only
+// enforced when budgeted
+struct scope {
+    explicit scope(script *script, bool budgeted = true);
+    ~scope();
+    scope(const scope &) = delete;
+    scope &operator=(const scope &) = delete;
+
+  private:
+    script *m_prev_script;
+    bool m_prev_budgeted;
+};
+
+// counts one shape, and for the current script, nested scopes count once
+struct shape_scope {
+    explicit shape_scope(draw::shape_type type);
+    ~shape_scope();
+    shape_scope(const shape_scope &) = delete;
+    shape_scope &operator=(const shape_scope &) = delete;
+
+    // splits the time spent so far into construction, the rest is emission
+    void constructed();
+
+    bool m_dropped{};
+
+  private:
+    bool m_nested{};
+    int m_vtx_begin{};
+    std::chrono::steady_clock::time_point m_start{};
+    std::chrono::steady_clock::time_point m_constructed{};
+};
+
+// cached geometry replayed for the current script
+void add_replayed(size_t vertices);
+// stores g_frame into the history, rotates the script counters and picks
+// the next cutoffs, render_start is when do_render was entered
+void end_frame(std::chrono::steady_clock::time_point render_start);
+void clear();
+} // namespace stats
@@ -0,0 +1,21 @@
+#include "trail.h"
+
+#include <algorithm>
+
+trail::history::history(size_t max_points)
+    : m_points(std::max<size_t>(max_points, 2)) {}
+
+void trail::history::push(const point &point) {
+    if (m_count < m_points.size()) {
+        m_points[(m_head + m_count) % m_points.size()] = point;
+        m_count++;
+        return;
+    }
+    m_points[m_head] = point;
+    m_head = (m_head + 1) % m_points.size();
+}
+
+void trail::history::clear() {
+    m_head = 0;
+    m_count = 0;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "math_types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// position history of a trail, kept in a fixed ring buffer so pushing never
+// allocates
+namespace trail {
+struct point {
+    Vector3f pos;
+    // world units, across the ribbon
+    float width;
+    uint32_t color;
+};
+
+struct history {
+    explicit history(size_t max_points);
+
+    // overwrites the oldest point once full
+    void push(const point &point);
+    void clear();
+    size_t size() const { return m_count; }
+    size_t capacity() const { return m_points.size(); }
+    // 0 is the oldest point
+    const point &operator[](size_t i) const {
+        return m_points[(m_head + i) % m_points.size()];
+    }
+
+  private:
+    std::vector<point> m_points;
+    size_t m_head{};
+    size_t m_count{};
+};
+} // namespace trail
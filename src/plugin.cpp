@@ -4,11 +4,28 @@
 #include "rendering/d3d12.hpp"
 #include <sol/sol.hpp>
 
+#include "bindings.h"
+#include "buffer.h"
+#include "bulk.h"
+#include "cache.h"
+#include "capture.h"
+#include "core.h"
+#include "display_list.h"
 #include "draw.h"
+#include "labels.h"
+#include "memory.h"
 #include "plugin.h"
+#include "profiler.h"
+#include "retained.h"
 #include "scene.h"
+#include "stats.h"
 
+#include <algorithm>
+#include <chrono>
+#include <memory>
 #include <mutex>
+#include <tuple>
+#include <utility>
 
 using API = reframework::API;
 
@@ -20,6 +37,7 @@ bool initialize_imgui() {
     }
 
     IMGUI_CHECKVERSION();
+    memory::install_imgui();
     ImGui::CreateContext();
 
     const auto renderer = API::get()->param()->renderer_data;
@@ -51,36 +69,182 @@ bool imgui_ok() {
                    ->renderer_data->command_queue != nullptr;
 }
 
+bool begin_frame() {
+    if (g_hbdraw.camera.is_frame_gen || !g_hbdraw.imgui.initialized) {
+        return false;
+    }
+
+    if (g_hbdraw.do_new_frame) {
+        const auto start = std::chrono::steady_clock::now();
+        const auto updated = scene::update_camera();
+        const std::chrono::duration<double, std::micro> elapsed =
+            std::chrono::steady_clock::now() - start;
+        stats::g_frame.camera_us += elapsed.count();
+        if (!updated) {
+            return false;
+        }
+        g_hbdraw.do_new_frame = false;
+        ImGui_ImplDX12_NewFrame();
+        ImGui_ImplWin32_NewFrame();
+        ImGui::NewFrame();
+        g_core.drawlist = ImGui::GetBackgroundDrawList();
+        capture::begin_frame(*scene::get_projection());
+    }
+    return true;
+}
+
 template <typename R, typename... Args>
 auto new_frame_wrapper(R (*func)(Args...)) {
-    return [func](Args... args) {
+    return [func](sol::this_state s, Args... args) {
+        HB_DRAW_ZONE("new_frame_wrapper");
+        const memory::scope binding{memory::subsystem::binding};
         std::lock_guard _{g_hbdraw.mutex};
-        if (g_hbdraw.camera.is_frame_gen || !g_hbdraw.imgui.initialized) {
+        if (!display_list::is_recording() && !begin_frame()) {
             return;
         }
+        stats::scope scope{bindings::get_caller(s)};
+        func(args...);
+    };
+}
 
-        if (g_hbdraw.do_new_frame) {
-            if (!scene::update_camera()) {
-                return;
+template <typename Rot>
+auto rotated_wrapper(void (*func)(const Vector3f &, const Vector3f &,
+                                  const Rot &, ImU32, bool, ImU32)) {
+    return new_frame_wrapper(func);
+}
+
+// same as new_frame_wrapper but colors, outline, segments, thickness and lod
+// come from a style handle passed in place of the trailing color args
+template <typename... Args, size_t... I>
+auto styled_wrapper(void (*func)(Args...), std::index_sequence<I...>) {
+    using args_t = std::tuple<Args...>;
+    return [func](sol::this_state s, std::tuple_element_t<I, args_t>... args,
+                  const draw::style &style) {
+        HB_DRAW_ZONE("styled_wrapper");
+        const memory::scope binding{memory::subsystem::binding};
+        std::lock_guard _{g_hbdraw.mutex};
+        if (!display_list::is_recording() && !begin_frame()) {
+            return;
+        }
+        stats::scope scope{bindings::get_caller(s)};
+        draw::scoped_style scoped{style};
+        func(args..., style.color, style.outline, style.color_outline);
+    };
+}
+
+template <typename... Args> auto styled_wrapper(void (*func)(Args...)) {
+    return styled_wrapper(func,
+                          std::make_index_sequence<sizeof...(Args) - 3>{});
+}
+
+template <typename Rot>
+auto rotated_styled_wrapper(void (*func)(const Vector3f &, const Vector3f &,
+                                         const Rot &, ImU32, bool, ImU32)) {
+    return styled_wrapper(func);
+}
+
+template <typename Rot>
+using instances_fn = void (*)(const Vector3f &, const Rot &,
+                              const sol::table &, ImU32, bool, ImU32);
+
+template <typename Rot> auto instances_wrapper(instances_fn<Rot> func) {
+    return new_frame_wrapper(func);
+}
+
+template <typename Rot> auto instances_styled_wrapper(instances_fn<Rot> func) {
+    return styled_wrapper(func);
+}
+
+template <typename Rot>
+auto axes_wrapper(void (*func)(const Vector3f &, const Rot &, float)) {
+    return new_frame_wrapper(func);
+}
+
+template <typename T>
+void set_style(draw::style &style, T draw::style::*member, const T &value) {
+    std::lock_guard _{g_hbdraw.mutex};
+    if (style.*member == value) {
+        return;
+    }
+    style.*member = value;
+    style.version++;
+}
+
+void bind_style(sol::state_view &lua, sol::table &hb_draw) {
+    lua.new_usertype<draw::style>(
+        "hb_draw_style", sol::no_constructor,
+        "set_fill",
+        [](draw::style &self, ImU32 color) {
+            set_style(self, &draw::style::color, color);
+        },
+        "set_outline",
+        [](draw::style &self, sol::object color_outline) {
+            const auto outline = color_outline.is<ImU32>();
+            set_style(self, &draw::style::outline, outline);
+            if (outline) {
+                set_style(self, &draw::style::color_outline,
+                          color_outline.as<ImU32>());
             }
-            g_hbdraw.do_new_frame = false;
-            ImGui_ImplDX12_NewFrame();
-            ImGui_ImplWin32_NewFrame();
-            ImGui::NewFrame();
+        },
+        "set_thickness",
+        [](draw::style &self, float thickness) {
+            set_style(self, &draw::style::thickness, thickness);
+        },
+        "set_segments",
+        [](draw::style &self, unsigned num) {
+            set_style(self, &draw::style::num_segments,
+                      std::max(num, min_segments));
+        },
+        "set_lod_tolerance", [](draw::style &self, float tolerance) {
+            set_style(self, &draw::style::lod_tolerance, tolerance);
+        });
+
+    // outline is a color or false/nil, unset values fall back to the globals
+    hb_draw["style"] = [](const sol::table &params) {
+        auto style = std::make_shared<draw::style>();
+        style->color = params.get_or<ImU32>("fill", 0);
+        const sol::object outline = params["outline"];
+        if (outline.is<ImU32>()) {
+            style->outline = true;
+            style->color_outline = outline.as<ImU32>();
         }
-        func(args...);
+        style->thickness =
+            params.get_or("thickness", g_core.outline_tickness);
+        style->num_segments = std::max(
+            params.get_or("segments", g_core.num_segments), min_segments);
+        style->lod_tolerance = params.get_or("lod_tolerance", 0.0f);
+        return style;
     };
 }
 
 void do_render() {
+    HB_DRAW_ZONE("do_render");
     std::lock_guard _{g_hbdraw.mutex};
-    if (!imgui_ok() || g_hbdraw.do_new_frame) {
+    const auto start = std::chrono::steady_clock::now();
+    display_list::abort();
+    if (!imgui_ok()) {
+        return;
+    }
+
+    if (!retained::empty() && begin_frame()) {
+        retained::draw_all();
+    }
+
+    if (g_hbdraw.do_new_frame) {
         return;
     }
 
     ImGui::Render();
-    g_d3d12.render_imgui();
+    {
+        HB_DRAW_ZONE("D3D12::render_imgui");
+        g_d3d12.render_imgui();
+    }
     g_hbdraw.do_new_frame = true;
+    capture::end_frame();
+    cache::end_frame();
+    labels::end_frame();
+    stats::end_frame(start);
+    profiler::end_frame();
 }
 
 void on_lua_state_created(lua_State *l) {
@@ -89,19 +253,81 @@ void on_lua_state_created(lua_State *l) {
     sol::state_view lua{g_hbdraw.lua};
 
     auto hb_draw = lua.create_table();
-    hb_draw["cylinder"] = new_frame_wrapper(draw::draw_cylinder);
-    hb_draw["ring"] = new_frame_wrapper(draw::draw_ring);
-    hb_draw["box"] = new_frame_wrapper(draw::draw_box);
-    hb_draw["triangle"] = new_frame_wrapper(draw::draw_triangle);
-    hb_draw["capsule"] = new_frame_wrapper(draw::draw_capsule);
-    hb_draw["sphere"] = new_frame_wrapper(draw::draw_sphere);
+    hb_draw["cylinder"] = sol::overload(new_frame_wrapper(draw::draw_cylinder),
+                                        styled_wrapper(draw::draw_cylinder));
+    hb_draw["ring"] = sol::overload(new_frame_wrapper(draw::draw_ring),
+                                    styled_wrapper(draw::draw_ring));
+    hb_draw["box"] = sol::overload(
+        rotated_wrapper<Matrix4x4f>(draw::draw_box),
+        rotated_wrapper<glm::quat>(draw::draw_box),
+        rotated_wrapper<Matrix3x3f>(draw::draw_box),
+        rotated_styled_wrapper<Matrix4x4f>(draw::draw_box),
+        rotated_styled_wrapper<glm::quat>(draw::draw_box),
+        rotated_styled_wrapper<Matrix3x3f>(draw::draw_box));
+    hb_draw["triangle"] = sol::overload(
+        rotated_wrapper<Matrix4x4f>(draw::draw_triangle),
+        rotated_wrapper<glm::quat>(draw::draw_triangle),
+        rotated_wrapper<Matrix3x3f>(draw::draw_triangle),
+        rotated_styled_wrapper<Matrix4x4f>(draw::draw_triangle),
+        rotated_styled_wrapper<glm::quat>(draw::draw_triangle),
+        rotated_styled_wrapper<Matrix3x3f>(draw::draw_triangle));
+    hb_draw["capsule"] = sol::overload(new_frame_wrapper(draw::draw_capsule),
+                                       styled_wrapper(draw::draw_capsule));
+    hb_draw["cone"] = sol::overload(new_frame_wrapper(draw::draw_cone),
+                                    styled_wrapper(draw::draw_cone));
+    hb_draw["sphere"] = sol::overload(new_frame_wrapper(draw::draw_sphere),
+                                      styled_wrapper(draw::draw_sphere));
+    hb_draw["ellipsoid"] = sol::overload(
+        rotated_wrapper<Matrix4x4f>(draw::draw_ellipsoid),
+        rotated_wrapper<glm::quat>(draw::draw_ellipsoid),
+        rotated_wrapper<Matrix3x3f>(draw::draw_ellipsoid),
+        rotated_styled_wrapper<Matrix4x4f>(draw::draw_ellipsoid),
+        rotated_styled_wrapper<glm::quat>(draw::draw_ellipsoid),
+        rotated_styled_wrapper<Matrix3x3f>(draw::draw_ellipsoid));
+    hb_draw["cylinders"] = new_frame_wrapper(bulk::draw_cylinders);
+    hb_draw["rings"] = new_frame_wrapper(bulk::draw_rings);
+    hb_draw["boxes"] = new_frame_wrapper(bulk::draw_boxes);
+    hb_draw["triangles"] = new_frame_wrapper(bulk::draw_triangles);
+    hb_draw["capsules"] = new_frame_wrapper(bulk::draw_capsules);
+    hb_draw["spheres"] = new_frame_wrapper(bulk::draw_spheres);
+    hb_draw["ellipsoids"] = new_frame_wrapper(bulk::draw_ellipsoids);
+    hb_draw["cones"] = new_frame_wrapper(bulk::draw_cones);
+    hb_draw["lines"] = new_frame_wrapper(bulk::draw_lines);
+    hb_draw["arrows"] = new_frame_wrapper(bulk::draw_arrows);
+    hb_draw["labels"] = new_frame_wrapper(bulk::draw_labels);
+    hb_draw["axes"] =
+        sol::overload(axes_wrapper<Matrix4x4f>(bulk::draw_axes),
+                      axes_wrapper<glm::quat>(bulk::draw_axes));
+    hb_draw["sphere_instances"] =
+        sol::overload(new_frame_wrapper(bulk::draw_sphere_instances),
+                      styled_wrapper(bulk::draw_sphere_instances));
+    hb_draw["box_instances"] = sol::overload(
+        instances_wrapper<Matrix4x4f>(bulk::draw_box_instances),
+        instances_wrapper<glm::quat>(bulk::draw_box_instances),
+        instances_styled_wrapper<Matrix4x4f>(bulk::draw_box_instances),
+        instances_styled_wrapper<glm::quat>(bulk::draw_box_instances));
+    hb_draw["triangle_instances"] = sol::overload(
+        instances_wrapper<Matrix4x4f>(bulk::draw_triangle_instances),
+        instances_wrapper<glm::quat>(bulk::draw_triangle_instances),
+        instances_styled_wrapper<Matrix4x4f>(bulk::draw_triangle_instances),
+        instances_styled_wrapper<glm::quat>(bulk::draw_triangle_instances));
+    hb_draw["draw_buffer"] = new_frame_wrapper(buffer::draw_buffer);
     hb_draw["set_num_segments"] = [&](unsigned num) {
-        g_hbdraw.imgui.num_segments = num;
+        g_core.num_segments = std::max(num, min_segments);
+        g_core.camera_version++;
+    };
+    hb_draw["set_outline_tickness"] = [&](float num) {
+        g_core.outline_tickness = num;
+        g_core.camera_version++;
     };
-    hb_draw["set_outline_tickness"] = [&](unsigned num) {
-        g_hbdraw.imgui.outline_tickness = num;
+    hb_draw["set_w2s"] = [&](bool b) {
+        g_hbdraw.w2s = b;
+        g_core.camera_version++;
     };
-    hb_draw["set_w2s"] = [&](bool b) { g_hbdraw.w2s = b; };
+    bind_style(lua, hb_draw);
+    bindings::bind(lua, hb_draw);
+    retained::bind(lua, hb_draw);
+    buffer::bind(lua, hb_draw);
     lua["hb_draw"] = hb_draw;
 }
 
@@ -111,16 +337,28 @@ void on_device_reset() {
     g_hbdraw.imgui.initialized = false;
     g_hbdraw.camera = {};
     g_hbdraw.do_new_frame = true;
+    // cached vertices reference the old font atlas uvs
+    g_core.camera_version++;
+    labels::clear();
 }
 
 void on_lua_state_destroyed(lua_State *l) {
     API::LuaLock _{};
+    std::lock_guard lock{g_hbdraw.mutex};
     g_hbdraw.lua = nullptr;
+    display_list::abort();
+    capture::stop();
+    retained::clear();
+    cache::clear();
+    labels::clear();
+    stats::clear();
+    profiler::clear();
 }
 
 extern "C" __declspec(dllexport) bool
 reframework_plugin_initialize(const REFrameworkPluginInitializeParam *param) {
     API::initialize(param);
+    g_core.projection = scene::get_projection();
 
     const auto functions = param->functions;
     functions->on_lua_state_created(on_lua_state_created);
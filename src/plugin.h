@@ -1,23 +1,26 @@
 #pragma once
 
+#include "imgui.h"
 #include <sol/sol.hpp>
 
 #include "scene.h"
+
 #include <mutex>
 
 struct imgui {
     bool initialized{false};
-    unsigned num_segments = 32;
-    unsigned outline_tickness = 1;
 };
 
 struct hbdraw {
     lua_State *lua{};
     std::mutex mutex;
-    camera camera{};
+    ::camera camera{};
     bool w2s{true};
-    imgui imgui{};
+    ::imgui imgui{};
     bool do_new_frame{true};
 };
 
 extern hbdraw g_hbdraw;
+
+// starts the imgui frame if needed, g_hbdraw.mutex has to be held
+bool begin_frame();
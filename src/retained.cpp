@@ -0,0 +1,658 @@
+#include "imgui.h"
+#include "reframework/API.hpp"
+#include "reframework/Math.hpp"
+#include <sol/sol.hpp>
+
+#include "bindings.h"
+#include "core.h"
+#include "draw.h"
+#include "plugin.h"
+#include "retained.h"
+#include "scene.h"
+#include "stats.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+// two vertices per point have to fit the 16 bit indices of one strip
+constexpr size_t max_trail_points = 4096;
+
+std::vector<std::shared_ptr<retained::shape>> g_shapes;
+// cleared when shapes are added or restyled, draw_all then regroups them
+bool g_grouped{true};
+
+void draw_shape(const retained::shape &shape) {
+    auto a = shape.a;
+    auto b = shape.b;
+    auto rot = shape.rot;
+
+    if (shape.parent) {
+        const auto &parent = *shape.parent;
+        a = parent.pos + parent.rot * shape.a;
+        switch (shape.type) {
+        case retained::shape_type::box:
+        case retained::shape_type::triangle:
+        case retained::shape_type::ellipsoid:
+        case retained::shape_type::hull:
+            rot = glm::mat4_cast(parent.rot) * shape.rot;
+            break;
+        case retained::shape_type::cylinder:
+        case retained::shape_type::ring:
+        case retained::shape_type::capsule:
+        case retained::shape_type::cone:
+            b = parent.pos + parent.rot * shape.b;
+            break;
+        default:
+            break;
+        }
+    }
+
+    const auto color = shape.style ? shape.style->color : shape.color;
+    const auto outline = shape.style ? shape.style->outline : shape.outline;
+    const auto color_outline =
+        shape.style ? shape.style->color_outline : shape.color_outline;
+
+    switch (shape.type) {
+    case retained::shape_type::sphere:
+        draw::draw_sphere(a, shape.radius_a, color, outline, color_outline);
+        break;
+    case retained::shape_type::box:
+        draw::draw_box(a, b, rot, color, outline, color_outline);
+        break;
+    case retained::shape_type::triangle:
+        draw::draw_triangle(a, b, rot, color, outline, color_outline);
+        break;
+    case retained::shape_type::cylinder:
+        draw::draw_cylinder(a, b, shape.radius_a, color, outline,
+                            color_outline);
+        break;
+    case retained::shape_type::ring:
+        draw::draw_ring(a, b, shape.radius_a, shape.radius_b, color, outline,
+                        color_outline);
+        break;
+    case retained::shape_type::capsule:
+        draw::draw_capsule(a, b, shape.radius_a, color, outline,
+                           color_outline);
+        break;
+    case retained::shape_type::ellipsoid:
+        draw::draw_ellipsoid(a, b, rot, color, outline, color_outline);
+        break;
+    case retained::shape_type::cone:
+        draw::draw_cone(a, b, shape.radius_a, shape.radius_b, color, outline,
+                        color_outline);
+        break;
+    case retained::shape_type::hull:
+        draw::draw_hull(*shape.hull, a, Matrix3x3f(rot), color, outline,
+                        color_outline);
+        break;
+    case retained::shape_type::trail:
+        draw::draw_trail(*shape.trail);
+        break;
+    case retained::shape_type::lines:
+    case retained::shape_type::labels:
+        break;
+    }
+}
+
+// memory the game already freed is not ours to release
+void release(reframework::API::ManagedObject *obj) {
+    if (obj->is_managed_object()) {
+        obj->release();
+    }
+}
+
+void release(retained::shape &shape) {
+    shape.destroyed = true;
+    if (shape.parent) {
+        release(shape.parent->transform);
+        if (shape.parent->is_joint) {
+            release(shape.parent->object);
+        }
+    }
+}
+
+using ref_counts =
+    std::unordered_map<reframework::API::ManagedObject *, uint32_t>;
+
+// false once the game destroyed what the shape is attached to. a joint that
+// goes away while its transform lives on, like after a mesh swap, is looked
+// up again by name
+bool revalidate(retained::attachment &parent, const ref_counts &refs) {
+    if (!scene::is_alive(parent.transform, refs.at(parent.transform))) {
+        return false;
+    }
+    if (!parent.is_joint || scene::is_alive(parent.object,
+                                            refs.at(parent.object))) {
+        return true;
+    }
+
+    const auto joint =
+        scene::get_joint(parent.transform, parent.joint_name.c_str());
+    if (joint == nullptr || !joint->is_managed_object()) {
+        return false;
+    }
+    joint->add_ref();
+    release(parent.object);
+    parent.object = joint;
+    return true;
+}
+
+// reads every attached transform/joint once, shapes sharing a joint share
+// the read. shapes whose transform or joint is gone are destroyed
+void update_parents() {
+    static ref_counts refs;
+    static std::unordered_map<reframework::API::ManagedObject *,
+                              std::pair<Vector3f, glm::quat>>
+        frame_transforms;
+    refs.clear();
+    frame_transforms.clear();
+
+    // every attached shape holds one reference on its transform and one on
+    // its joint
+    for (const auto &shape : g_shapes) {
+        if (shape->parent) {
+            refs[shape->parent->transform]++;
+            if (shape->parent->is_joint) {
+                refs[shape->parent->object]++;
+            }
+        }
+    }
+
+    bool dropped = false;
+    for (const auto &shape : g_shapes) {
+        if (!shape->parent) {
+            continue;
+        }
+
+        auto &parent = *shape->parent;
+        if (!revalidate(parent, refs)) {
+            release(*shape);
+            dropped = true;
+            continue;
+        }
+        if (!shape->visible) {
+            continue;
+        }
+
+        auto it = frame_transforms.find(parent.object);
+        if (it == frame_transforms.end()) {
+            std::pair<Vector3f, glm::quat> transform;
+            scene::get_world_transform(parent.object, parent.is_joint,
+                                       transform.first, transform.second);
+            it = frame_transforms.emplace(parent.object, transform).first;
+        }
+
+        const auto &[pos, rot] = it->second;
+        if (pos != parent.pos || rot != parent.rot) {
+            parent.pos = pos;
+            parent.rot = rot;
+            shape->dirty = true;
+        }
+    }
+
+    if (dropped) {
+        std::erase_if(g_shapes,
+                      [](const auto &shape) { return shape->destroyed; });
+    }
+}
+
+// accepts a via.Transform or its address, anything the sdk does not know as
+// one is rejected
+reframework::API::ManagedObject *to_transform(const sol::object &obj) {
+    reframework::API::ManagedObject *ret{};
+    if (obj.get_type() == sol::type::number) {
+        ret = (reframework::API::ManagedObject *)obj.as<uintptr_t>();
+    } else if (obj.get_type() == sol::type::userdata) {
+        const auto ud = obj.as<sol::userdata>();
+        const sol::protected_function get_address = ud["get_address"];
+        if (get_address.valid()) {
+            const auto res = get_address(ud);
+            if (res.valid()) {
+                ret = (reframework::API::ManagedObject *)res.get<uintptr_t>();
+            }
+        }
+    }
+    return scene::is_transform(ret) ? ret : nullptr;
+}
+
+std::shared_ptr<retained::shape> create(lua_State *l, retained::shape &&shape) {
+    std::lock_guard _{g_hbdraw.mutex};
+    g_grouped = false;
+    shape.script = bindings::get_caller(l);
+    return g_shapes.emplace_back(
+        std::make_shared<retained::shape>(std::move(shape)));
+}
+
+std::shared_ptr<retained::shape> attach(lua_State *l,
+                                        const sol::object &transform_obj,
+                                        sol::optional<std::string> joint_name,
+                                        retained::shape &&shape) {
+    const auto transform = to_transform(transform_obj);
+    if (transform == nullptr) {
+        return nullptr;
+    }
+
+    retained::attachment parent{transform, transform, false};
+    if (joint_name && !joint_name->empty()) {
+        parent.object = scene::get_joint(transform, joint_name->c_str());
+        parent.is_joint = true;
+        parent.joint_name = *joint_name;
+        if (parent.object == nullptr || !parent.object->is_managed_object()) {
+            return nullptr;
+        }
+        parent.object->add_ref();
+    }
+
+    // keeps the memory valid while the shape references it, whether the
+    // game still uses them is checked every frame
+    transform->add_ref();
+    shape.parent = parent;
+    return create(l, std::move(shape));
+}
+
+template <typename T>
+void set(retained::shape &shape, T retained::shape::*member, const T &value) {
+    std::lock_guard _{g_hbdraw.mutex};
+    if (shape.destroyed || shape.*member == value) {
+        return;
+    }
+    shape.*member = value;
+    shape.dirty = true;
+}
+} // namespace
+
+void retained::draw_all() {
+    update_parents();
+    if (!g_grouped) {
+        std::stable_sort(g_shapes.begin(), g_shapes.end(),
+                         [](const auto &a, const auto &b) {
+                             return a->style < b->style;
+                         });
+        g_grouped = true;
+    }
+
+    // style state is applied once per group
+    const draw::style *current_style{};
+    std::optional<draw::scoped_style> scoped{};
+    for (const auto &shape : g_shapes) {
+        if (!shape->visible) {
+            continue;
+        }
+
+        if (shape->style.get() != current_style) {
+            current_style = shape->style.get();
+            scoped.reset();
+            if (current_style) {
+                scoped.emplace(*current_style);
+            }
+        }
+
+        if (current_style && current_style->version != shape->style_version) {
+            shape->style_version = current_style->version;
+            shape->dirty = true;
+        }
+
+        // retained shapes count toward their creator but are never dropped
+        stats::scope scope{shape->script, false};
+        if (draw::util::replay_retained(shape->mesh, shape->dirty,
+                                        shape->camera_version)) {
+            continue;
+        }
+
+        const auto capture = draw::util::begin_capture();
+        draw_shape(*shape);
+        shape->dirty = !draw::util::end_capture(capture, shape->mesh);
+        shape->camera_version = g_core.camera_version;
+    }
+}
+
+bool retained::empty() { return g_shapes.empty(); }
+
+void retained::clear() {
+    for (const auto &shape : g_shapes) {
+        release(*shape);
+    }
+    g_shapes.clear();
+}
+
+void retained::bind(sol::state_view &lua, sol::table &hb_draw) {
+    lua.new_usertype<shape>(
+        "hb_draw_shape", sol::no_constructor,
+        "set_position",
+        [](shape &self, const Vector3f &pos) {
+            std::lock_guard _{g_hbdraw.mutex};
+            if (self.destroyed || self.a == pos) {
+                return;
+            }
+            // segment shapes keep their length and direction
+            if (self.type == shape_type::cylinder ||
+                self.type == shape_type::ring ||
+                self.type == shape_type::capsule ||
+                self.type == shape_type::cone) {
+                self.b += pos - self.a;
+            }
+            self.a = pos;
+            self.dirty = true;
+        },
+        "set_start",
+        [](shape &self, const Vector3f &start) { set(self, &shape::a, start); },
+        "set_end",
+        [](shape &self, const Vector3f &end) { set(self, &shape::b, end); },
+        "set_extent",
+        [](shape &self, const Vector3f &extent) {
+            set(self, &shape::b, extent);
+        },
+        "set_rotation",
+        [](shape &self, const Matrix4x4f &rot) { set(self, &shape::rot, rot); },
+        "set_radius",
+        [](shape &self, float radius) { set(self, &shape::radius_a, radius); },
+        "set_radius_b",
+        [](shape &self, float radius) { set(self, &shape::radius_b, radius); },
+        "set_color",
+        [](shape &self, ImU32 color) { set(self, &shape::color, color); },
+        "set_outline",
+        [](shape &self, bool outline, ImU32 color_outline) {
+            set(self, &shape::outline, outline);
+            set(self, &shape::color_outline, color_outline);
+        },
+        "set_style",
+        [](shape &self, sol::optional<std::shared_ptr<draw::style>> style) {
+            std::lock_guard _{g_hbdraw.mutex};
+            auto ptr = style.value_or(nullptr);
+            if (self.destroyed || self.style == ptr) {
+                return;
+            }
+            self.style = std::move(ptr);
+            self.style_version = self.style ? self.style->version : 0;
+            self.dirty = true;
+            g_grouped = false;
+        },
+        "set_visible",
+        [](shape &self, bool visible) {
+            std::lock_guard _{g_hbdraw.mutex};
+            self.visible = visible;
+        },
+        "is_visible", [](const shape &self) { return self.visible; },
+        "push",
+        [](shape &self, const Vector3f &pos, float width, ImU32 color) {
+            std::lock_guard _{g_hbdraw.mutex};
+            if (self.destroyed || !self.trail) {
+                return;
+            }
+            self.trail->push({pos, width, color});
+            self.dirty = true;
+        },
+        "clear_points",
+        [](shape &self) {
+            std::lock_guard _{g_hbdraw.mutex};
+            if (self.destroyed || !self.trail || self.trail->size() == 0) {
+                return;
+            }
+            self.trail->clear();
+            self.dirty = true;
+        },
+        "destroy",
+        [](shape &self) {
+            std::lock_guard _{g_hbdraw.mutex};
+            if (self.destroyed) {
+                return;
+            }
+            release(self);
+            std::erase_if(g_shapes,
+                          [&](const auto &ptr) { return ptr.get() == &self; });
+        });
+
+    hb_draw["create_sphere"] = [](sol::this_state s, const Vector3f &center,
+                                  float radius, ImU32 color, bool outline,
+                                  ImU32 color_outline) {
+        return create(s, {.type = shape_type::sphere,
+                          .a = center,
+                          .radius_a = radius,
+                          .color = color,
+                          .outline = outline,
+                          .color_outline = color_outline});
+    };
+    hb_draw["create_box"] = [](sol::this_state s, const Vector3f &pos,
+                               const Vector3f &extent, const Matrix4x4f &rot,
+                               ImU32 color, bool outline, ImU32 color_outline) {
+        return create(s, {.type = shape_type::box,
+                          .a = pos,
+                          .b = extent,
+                          .rot = rot,
+                          .color = color,
+                          .outline = outline,
+                          .color_outline = color_outline});
+    };
+    hb_draw["create_triangle"] = [](sol::this_state s, const Vector3f &pos,
+                                    const Vector3f &extent,
+                                    const Matrix4x4f &rot, ImU32 color,
+                                    bool outline, ImU32 color_outline) {
+        return create(s, {.type = shape_type::triangle,
+                          .a = pos,
+                          .b = extent,
+                          .rot = rot,
+                          .color = color,
+                          .outline = outline,
+                          .color_outline = color_outline});
+    };
+    hb_draw["create_cylinder"] = [](sol::this_state s, const Vector3f &start,
+                                    const Vector3f &end, float radius,
+                                    ImU32 color, bool outline,
+                                    ImU32 color_outline) {
+        return create(s, {.type = shape_type::cylinder,
+                          .a = start,
+                          .b = end,
+                          .radius_a = radius,
+                          .color = color,
+                          .outline = outline,
+                          .color_outline = color_outline});
+    };
+    hb_draw["create_ring"] = [](sol::this_state s, const Vector3f &start,
+                                const Vector3f &end, float radius_a,
+                                float radius_b, ImU32 color, bool outline,
+                                ImU32 color_outline) {
+        return create(s, {.type = shape_type::ring,
+                          .a = start,
+                          .b = end,
+                          .radius_a = radius_a,
+                          .radius_b = radius_b,
+                          .color = color,
+                          .outline = outline,
+                          .color_outline = color_outline});
+    };
+    hb_draw["create_cone"] = [](sol::this_state s, const Vector3f &start,
+                                const Vector3f &end, float radius_start,
+                                float radius_end, ImU32 color, bool outline,
+                                ImU32 color_outline) {
+        return create(s, {.type = shape_type::cone,
+                          .a = start,
+                          .b = end,
+                          .radius_a = radius_start,
+                          .radius_b = radius_end,
+                          .color = color,
+                          .outline = outline,
+                          .color_outline = color_outline});
+    };
+    hb_draw["create_capsule"] = [](sol::this_state s, const Vector3f &start,
+                                   const Vector3f &end, float radius,
+                                   ImU32 color, bool outline,
+                                   ImU32 color_outline) {
+        return create(s, {.type = shape_type::capsule,
+                          .a = start,
+                          .b = end,
+                          .radius_a = radius,
+                          .color = color,
+                          .outline = outline,
+                          .color_outline = color_outline});
+    };
+    hb_draw["create_ellipsoid"] = [](sol::this_state s, const Vector3f &center,
+                                     const Vector3f &radii,
+                                     const Matrix4x4f &rot, ImU32 color,
+                                     bool outline, ImU32 color_outline) {
+        return create(s, {.type = shape_type::ellipsoid,
+                          .a = center,
+                          .b = radii,
+                          .rot = rot,
+                          .color = color,
+                          .outline = outline,
+                          .color_outline = color_outline});
+    };
+    hb_draw["create_hull"] = [](sol::this_state s, const sol::table &points,
+                                ImU32 color, bool outline,
+                                ImU32 color_outline) -> std::shared_ptr<shape> {
+        std::vector<Vector3f> vertices;
+        vertices.reserve(points.size());
+        for (size_t i = 1; i <= points.size(); i++) {
+            vertices.push_back(points.get<Vector3f>(i));
+        }
+        // built outside the lock, quickhull is the slow part
+        auto mesh = hull::build(vertices);
+        if (!mesh) {
+            return nullptr;
+        }
+        return create(s, {.type = shape_type::hull,
+                          .hull = std::make_shared<const hull::mesh>(
+                              std::move(*mesh)),
+                          .color = color,
+                          .outline = outline,
+                          .color_outline = color_outline});
+    };
+    // drawn from the points pushed so far, push needs no further lua work
+    hb_draw["create_trail"] = [](sol::this_state s, size_t max_points) {
+        return create(s, {.type = shape_type::trail,
+                          .trail = std::make_shared<trail::history>(
+                              std::min(max_points, max_trail_points))});
+    };
+    hb_draw["attach_sphere"] = [](sol::this_state s,
+                                  const sol::object &transform,
+                                  sol::optional<std::string> joint_name,
+                                  const Vector3f &local_center, float radius,
+                                  ImU32 color, bool outline,
+                                  ImU32 color_outline) {
+        return attach(s, transform, joint_name,
+                      {.type = shape_type::sphere,
+                       .a = local_center,
+                       .radius_a = radius,
+                       .color = color,
+                       .outline = outline,
+                       .color_outline = color_outline});
+    };
+    hb_draw["attach_box"] = [](sol::this_state s, const sol::object &transform,
+                               sol::optional<std::string> joint_name,
+                               const Vector3f &local_pos,
+                               const Vector3f &extent,
+                               const Matrix4x4f &local_rot, ImU32 color,
+                               bool outline, ImU32 color_outline) {
+        return attach(s, transform, joint_name,
+                      {.type = shape_type::box,
+                       .a = local_pos,
+                       .b = extent,
+                       .rot = local_rot,
+                       .color = color,
+                       .outline = outline,
+                       .color_outline = color_outline});
+    };
+    hb_draw["attach_triangle"] = [](sol::this_state s,
+                                    const sol::object &transform,
+                                    sol::optional<std::string> joint_name,
+                                    const Vector3f &local_pos,
+                                    const Vector3f &extent,
+                                    const Matrix4x4f &local_rot, ImU32 color,
+                                    bool outline, ImU32 color_outline) {
+        return attach(s, transform, joint_name,
+                      {.type = shape_type::triangle,
+                       .a = local_pos,
+                       .b = extent,
+                       .rot = local_rot,
+                       .color = color,
+                       .outline = outline,
+                       .color_outline = color_outline});
+    };
+    hb_draw["attach_cylinder"] = [](sol::this_state s,
+                                    const sol::object &transform,
+                                    sol::optional<std::string> joint_name,
+                                    const Vector3f &local_start,
+                                    const Vector3f &local_end, float radius,
+                                    ImU32 color, bool outline,
+                                    ImU32 color_outline) {
+        return attach(s, transform, joint_name,
+                      {.type = shape_type::cylinder,
+                       .a = local_start,
+                       .b = local_end,
+                       .radius_a = radius,
+                       .color = color,
+                       .outline = outline,
+                       .color_outline = color_outline});
+    };
+    hb_draw["attach_ring"] = [](sol::this_state s, const sol::object &transform,
+                                sol::optional<std::string> joint_name,
+                                const Vector3f &local_start,
+                                const Vector3f &local_end, float radius_a,
+                                float radius_b, ImU32 color, bool outline,
+                                ImU32 color_outline) {
+        return attach(s, transform, joint_name,
+                      {.type = shape_type::ring,
+                       .a = local_start,
+                       .b = local_end,
+                       .radius_a = radius_a,
+                       .radius_b = radius_b,
+                       .color = color,
+                       .outline = outline,
+                       .color_outline = color_outline});
+    };
+    hb_draw["attach_cone"] = [](sol::this_state s, const sol::object &transform,
+                                sol::optional<std::string> joint_name,
+                                const Vector3f &local_start,
+                                const Vector3f &local_end, float radius_start,
+                                float radius_end, ImU32 color, bool outline,
+                                ImU32 color_outline) {
+        return attach(s, transform, joint_name,
+                      {.type = shape_type::cone,
+                       .a = local_start,
+                       .b = local_end,
+                       .radius_a = radius_start,
+                       .radius_b = radius_end,
+                       .color = color,
+                       .outline = outline,
+                       .color_outline = color_outline});
+    };
+    hb_draw["attach_capsule"] = [](sol::this_state s,
+                                   const sol::object &transform,
+                                   sol::optional<std::string> joint_name,
+                                   const Vector3f &local_start,
+                                   const Vector3f &local_end, float radius,
+                                   ImU32 color, bool outline,
+                                   ImU32 color_outline) {
+        return attach(s, transform, joint_name,
+                      {.type = shape_type::capsule,
+                       .a = local_start,
+                       .b = local_end,
+                       .radius_a = radius,
+                       .color = color,
+                       .outline = outline,
+                       .color_outline = color_outline});
+    };
+    hb_draw["attach_ellipsoid"] = [](sol::this_state s,
+                                     const sol::object &transform,
+                                     sol::optional<std::string> joint_name,
+                                     const Vector3f &local_center,
+                                     const Vector3f &radii,
+                                     const Matrix4x4f &local_rot, ImU32 color,
+                                     bool outline, ImU32 color_outline) {
+        return attach(s, transform, joint_name,
+                      {.type = shape_type::ellipsoid,
+                       .a = local_center,
+                       .b = radii,
+                       .rot = local_rot,
+                       .color = color,
+                       .outline = outline,
+                       .color_outline = color_outline});
+    };
+}
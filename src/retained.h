@@ -0,0 +1,74 @@
+#pragma once
+
+#include "imgui.h"
+#include "reframework/API.hpp"
+#include "reframework/Math.hpp"
+#include <sol/sol.hpp>
+
+#include "draw.h"
+#include "hull.h"
+#include "stats.h"
+#include "trail.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace retained {
+using draw::shape_type;
+
+// game transform or one of its joints, shape params are then in its local
+// space. the shape is destroyed once the game destroys either
+struct attachment {
+    reframework::API::ManagedObject *transform;
+    // joint, or the transform itself when no joint name was given
+    reframework::API::ManagedObject *object;
+    bool is_joint;
+    // the joint is looked up again by it when the game replaces it
+    std::string joint_name{};
+    // world transform read at the start of the frame
+    Vector3f pos{};
+    glm::quat rot{1.0f, 0.0f, 0.0f, 0.0f};
+};
+
+// shape stored on the c++ side and drawn every frame without lua, params
+// follow the argument order of the matching draw:: function
+struct shape {
+    shape_type type;
+    // sphere/ellipsoid center, box/triangle/hull pos,
+    // cylinder/ring/capsule/cone start
+    Vector3f a{};
+    // box/triangle extent, ellipsoid radii, cylinder/ring/capsule/cone end
+    Vector3f b{};
+    Matrix4x4f rot{1.0f};
+    float radius_a{};
+    float radius_b{};
+    // hull points are in local space, placed by a and rot
+    std::shared_ptr<const hull::mesh> hull{};
+    // points pushed from lua, the colors below are unused
+    std::shared_ptr<trail::history> trail{};
+    ImU32 color{};
+    bool outline{};
+    ImU32 color_outline{};
+    // overrides the colors above when set, shapes are drawn grouped by style
+    std::shared_ptr<draw::style> style{};
+    bool visible{true};
+    bool destroyed{false};
+    std::optional<attachment> parent{};
+    // script that created the shape, for stats
+    stats::script *script{};
+
+    // cached projection + tessellation, valid while not dirty and
+    // camera_version matches
+    bool dirty{true};
+    uint64_t camera_version{};
+    uint64_t style_version{};
+    draw::util::mesh mesh{};
+};
+
+void draw_all();
+bool empty();
+void clear();
+void bind(sol::state_view &lua, sol::table &hb_draw);
+} // namespace retained
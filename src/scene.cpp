@@ -1,9 +1,17 @@
 #include "reframework/Math.hpp"
 #include "reframework/sdk.h"
 
+#include "capture.h"
+#include "core.h"
 #include "plugin.h"
+#include "profiler.h"
+#include "projection.h"
 #include "scene.h"
+#include "stats.h"
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <optional>
 
 reframework::API::ManagedObject *scene::get_main_view() {
@@ -51,6 +59,69 @@ reframework::API::ManagedObject *scene::get_current_scene() {
     return scene;
 }
 
+namespace {
+// with w2s single points and batches both go through the native matrix
+// kernel once it matched via.math worldPos2ScreenPos, through the managed
+// call otherwise. the wilds camera util per point without w2s
+struct game_projection : matrix_projection {
+    std::optional<Vector2f> world_to_screen(const Vector3f &pos) override {
+        if (!g_hbdraw.w2s) {
+            return scene::world_to_screen_wilds(pos);
+        }
+        if (g_hbdraw.camera.is_kernel_ok) {
+            return matrix_projection::world_to_screen(pos);
+        }
+        return scene::world_to_screen_generic(pos);
+    }
+
+    void world_to_screen(const float *x, const float *y, const float *z,
+                         size_t count, Vector2f *out,
+                         uint8_t *visible) override {
+        if (g_hbdraw.w2s && g_hbdraw.camera.is_kernel_ok) {
+            matrix_projection::world_to_screen(x, y, z, count, out, visible);
+        } else {
+            projection::world_to_screen(x, y, z, count, out, visible);
+        }
+    }
+
+    std::optional<Matrix4x4f> get_screen_matrix() const override {
+        if (g_hbdraw.w2s && g_hbdraw.camera.is_kernel_ok) {
+            return matrix_projection::get_screen_matrix();
+        }
+        return std::nullopt;
+    }
+};
+
+game_projection g_projection{};
+
+// points in front of the camera at several depths, projected both ways.
+// more than half a pixel apart and the kernel is not used
+bool check_kernel() {
+    constexpr float tolerance = 0.5f;
+    const auto forward = -g_projection.forward;
+    const auto up = g_projection.up;
+    const auto right = glm::normalize(glm::cross(forward, up));
+    const std::array<Vector2f, 3> offsets{
+        {{0.0f, 0.0f}, {0.3f, -0.2f}, {-0.25f, 0.15f}}};
+
+    for (const auto depth : {1.0f, 10.0f, 100.0f}) {
+        for (const auto &offset : offsets) {
+            const auto pos = g_projection.origin + forward * depth +
+                             (right * offset.x + up * offset.y) * depth;
+            const auto managed = scene::world_to_screen_generic(pos);
+            const auto kernel = g_projection.project(pos);
+            if (managed.has_value() != kernel.has_value() ||
+                (managed && glm::distance(*managed, *kernel) > tolerance)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+} // namespace
+
+matrix_projection *scene::get_projection() { return &g_projection; }
+
 std::optional<Vector2f>
 scene::world_to_screen_generic(const Vector3f &world_pos) {
     auto &api = reframework::API::get();
@@ -69,19 +140,13 @@ scene::world_to_screen_generic(const Vector3f &world_pos) {
         return std::nullopt;
     }
 
+    stats::g_frame.managed_calls++;
     Vector2f screen_pos{};
     world_to_screen->call(&screen_pos, context, &pos, &g_hbdraw.camera.view,
                           &g_hbdraw.camera.proj, &g_hbdraw.camera.screen_size);
     return screen_pos;
 }
 
-std::optional<Vector2f> scene::world_to_screen(const Vector3f &world_pos) {
-    if (g_hbdraw.w2s) {
-        return world_to_screen_generic(world_pos);
-    }
-    return world_to_screen_wilds(world_pos);
-}
-
 std::optional<Vector2f>
 scene::world_to_screen_wilds(const Vector3f &world_pos) {
     auto &api = reframework::API::get();
@@ -101,6 +166,7 @@ scene::world_to_screen_wilds(const Vector3f &world_pos) {
         return std::nullopt;
     }
 
+    stats::g_frame.managed_calls++;
     Vector2f screen_pos{};
     world_to_screen->call(&screen_pos, context, &pos,
                           (void *)g_hbdraw.camera.nullable_via_size->address());
@@ -170,6 +236,7 @@ bool scene::setup_camera() {
 }
 
 bool scene::update_camera() {
+    HB_DRAW_ZONE("update_camera");
     if (is_frame_gen() || !setup_camera()) {
         return false;
     }
@@ -184,6 +251,12 @@ bool scene::update_camera() {
     static auto get_position_method =
         transform_def->find_method("get_Position");
 
+    const auto origin = g_hbdraw.camera.origin;
+    const auto forward = g_hbdraw.camera.forward;
+    const auto up = g_hbdraw.camera.up;
+    const auto proj = g_hbdraw.camera.proj;
+    const auto view = g_hbdraw.camera.view;
+
     // when passed by reference, calls sometimes just fail?, no exception or
     // anything
     g_hbdraw.camera.origin = get_position_method->call<Vector4f>(
@@ -193,17 +266,41 @@ bool scene::update_camera() {
     g_hbdraw.camera.up = get_axisy_method->call<Vector4f>(
         context, g_hbdraw.camera.camera_transform);
 
-    if (g_hbdraw.w2s) {
-        g_hbdraw.camera.camera->call("get_ProjectionMatrix",
-                                     &g_hbdraw.camera.proj, context,
-                                     g_hbdraw.camera.camera);
+    // also fetched without w2s, fov changes have to invalidate cached geometry
+    g_hbdraw.camera.camera->call("get_ProjectionMatrix", &g_hbdraw.camera.proj,
+                                 context, g_hbdraw.camera.camera);
+    stats::g_frame.managed_calls += 4;
+    // captures are replayed through the matrices
+    if (g_hbdraw.w2s || capture::is_capturing()) {
         g_hbdraw.camera.camera->call("get_ViewMatrix", &g_hbdraw.camera.view,
                                      context, g_hbdraw.camera.camera);
+        stats::g_frame.managed_calls++;
+    }
+
+    if (origin != g_hbdraw.camera.origin ||
+        forward != g_hbdraw.camera.forward || up != g_hbdraw.camera.up ||
+        proj != g_hbdraw.camera.proj || view != g_hbdraw.camera.view) {
+        g_core.camera_version++;
+    }
+
+    g_projection.view = g_hbdraw.camera.view;
+    g_projection.proj = g_hbdraw.camera.proj;
+    g_projection.origin = Vector3f{g_hbdraw.camera.origin};
+    g_projection.forward = Vector3f{g_hbdraw.camera.forward};
+    g_projection.up = Vector3f{g_hbdraw.camera.up};
+    g_projection.screen_size = {g_hbdraw.camera.screen_size[0],
+                                g_hbdraw.camera.screen_size[1]};
+
+    if (g_hbdraw.w2s && !g_hbdraw.camera.is_kernel_checked) {
+        g_hbdraw.camera.is_kernel_ok = check_kernel();
+        g_hbdraw.camera.is_kernel_checked = true;
+        g_core.camera_version++;
     }
     return true;
 }
 
 bool scene::is_frame_gen() {
+    HB_DRAW_ZONE("is_frame_gen");
     const auto &api = reframework::API::get();
     static auto upscaling_interface_type =
         api->tdb()->find_type("via.render.UpscalingInterface");
@@ -215,6 +312,7 @@ bool scene::is_frame_gen() {
     static auto upscaling_interface =
         api->get_native_singleton("via.render.UpscalingInterface");
 
+    stats::g_frame.managed_calls++;
     const auto res = using_frame_gen_method->call<bool>(
         api->sdk()->functions->get_vm_context(), upscaling_interface);
     if (res != g_hbdraw.camera.is_frame_gen) {
@@ -223,3 +321,69 @@ bool scene::is_frame_gen() {
     g_hbdraw.camera.is_frame_gen = res;
     return res;
 }
+
+reframework::API::ManagedObject *
+scene::get_joint(reframework::API::ManagedObject *transform, const char *name) {
+    auto &api = reframework::API::get();
+    auto context = api->sdk()->functions->get_vm_context();
+    const auto tdb = api->tdb();
+
+    static auto transform_def = tdb->find_type("via.Transform");
+    static auto get_joint_by_name_method =
+        transform_def->find_method("getJointByName(System.String)");
+
+    stats::g_frame.managed_calls += 2;
+    const auto managed_name =
+        api->sdk()->functions->create_managed_string_normal(name);
+    return get_joint_by_name_method->call<reframework::API::ManagedObject *>(
+        context, transform, managed_name);
+}
+
+bool scene::is_transform(reframework::API::ManagedObject *obj) {
+    if (obj == nullptr || !obj->is_managed_object()) {
+        return false;
+    }
+    static auto transform_def =
+        reframework::API::get()->tdb()->find_type("via.Transform");
+    return obj->get_type_definition() == transform_def;
+}
+
+bool scene::is_alive(reframework::API::ManagedObject *obj, uint32_t refs) {
+    return obj->is_managed_object() && obj->get_ref_count() > refs;
+}
+
+void scene::get_world_transform(reframework::API::ManagedObject *obj,
+                                bool is_joint, Vector3f &pos,
+                                glm::quat &rot) {
+    using get_vec_fn =
+        Vector4f (*)(void *, reframework::API::ManagedObject *);
+    using get_quat_fn =
+        glm::quat (*)(void *, reframework::API::ManagedObject *);
+
+    auto &api = reframework::API::get();
+    auto context = api->sdk()->functions->get_vm_context();
+    const auto tdb = api->tdb();
+
+    // resolved once, calling through Method::call would look the function up
+    // again on every invoke
+    static auto transform_def = tdb->find_type("via.Transform");
+    static auto joint_def = tdb->find_type("via.Joint");
+    static auto transform_get_position =
+        transform_def->find_method("get_Position")->get_function<get_vec_fn>();
+    static auto transform_get_rotation =
+        transform_def->find_method("get_Rotation")
+            ->get_function<get_quat_fn>();
+    static auto joint_get_position =
+        joint_def->find_method("get_Position")->get_function<get_vec_fn>();
+    static auto joint_get_rotation =
+        joint_def->find_method("get_Rotation")->get_function<get_quat_fn>();
+
+    stats::g_frame.managed_calls += 2;
+    if (is_joint) {
+        pos = Vector3f(joint_get_position(context, obj));
+        rot = joint_get_rotation(context, obj);
+    } else {
+        pos = Vector3f(transform_get_position(context, obj));
+        rot = transform_get_rotation(context, obj);
+    }
+}
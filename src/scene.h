@@ -4,6 +4,9 @@
 #include "reframework/Math.hpp"
 #include "reframework/sdk.h"
 
+#include "projection.h"
+
+#include <cstdint>
 #include <memory>
 #include <optional>
 
@@ -11,12 +14,23 @@ namespace scene {
 reframework::API::ManagedObject *get_primary_camera();
 reframework::API::ManagedObject *get_main_view();
 reframework::API::ManagedObject *get_current_scene();
-std::optional<Vector2f> world_to_screen(const Vector3f &world_pos);
+// game camera as a core projection, updated by update_camera
+matrix_projection *get_projection();
 std::optional<Vector2f> world_to_screen_generic(const Vector3f &world_pos);
 std::optional<Vector2f> world_to_screen_wilds(const Vector3f &world_pos);
 bool update_camera();
 bool setup_camera();
 bool is_frame_gen();
+reframework::API::ManagedObject *
+get_joint(reframework::API::ManagedObject *transform, const char *name);
+// obj is a live via.Transform, addresses from lua are checked with this
+// before anything reads them
+bool is_transform(reframework::API::ManagedObject *obj);
+// refs is how many references hb_draw holds on obj. once nothing else does
+// the game object owning it is gone, add_ref does not keep it working
+bool is_alive(reframework::API::ManagedObject *obj, uint32_t refs);
+void get_world_transform(reframework::API::ManagedObject *obj, bool is_joint,
+                         Vector3f &pos, glm::quat &rot);
 } // namespace scene
 
 struct camera {
@@ -32,4 +46,8 @@ struct camera {
     reframework::API::ManagedObject *camera_transform;
     bool is_setup{false};
     bool is_frame_gen{false};
+    // the native projection matched worldPos2ScreenPos, checked once per
+    // camera setup
+    bool is_kernel_checked{false};
+    bool is_kernel_ok{false};
 };
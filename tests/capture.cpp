@@ -0,0 +1,344 @@
+// capture round trip: frames are encoded through capture::*, read back with
+// capture::reader and every camera, style, record and position compared
+// bitwise. one frame is too large for the writer queue and has to be
+// dropped, the frames after it must still decode. a retained shape drawn
+// once before a capture has to be in every captured frame, not only the
+// first one
+//
+// > hb_draw_capture_test [dir]
+
+#include "imgui.h"
+
+#include "capture.h"
+#include "core.h"
+#include "draw.h"
+#include "math_types.h"
+#include "projection.h"
+
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr uint64_t frame_count = 8;
+// holds more positions than fit in the writer queue
+constexpr uint64_t dropped_frame = 4;
+constexpr uint64_t retained_frames = 4;
+
+struct primitive {
+    draw::shape_type type;
+    draw::style style;
+    bool instanced;
+    std::vector<float> record;
+    std::vector<Vector3f> positions;
+};
+
+struct frame {
+    matrix_projection camera{};
+    std::vector<primitive> primitives;
+};
+
+int g_failures{};
+
+void check(bool ok, const char *what, uint64_t frame) {
+    if (!ok) {
+        std::fprintf(stderr, "frame %llu: %s\n", (unsigned long long)frame,
+                     what);
+        g_failures++;
+    }
+}
+
+bool same_bits(const void *a, const void *b, size_t size) {
+    return std::memcmp(a, b, size) == 0;
+}
+
+// records are stored as raw float bits, colors included, so some are nan
+std::vector<float> make_record(size_t size, uint32_t seed) {
+    std::vector<float> ret(size);
+    for (size_t i = 0; i < size; i++) {
+        ret[i] = i % 4 == 3 ? std::bit_cast<float>(0xFF000000u | seed * 7919u)
+                            : (float)(seed * 31 + i) * 0.25f;
+    }
+    return ret;
+}
+
+draw::style make_style(unsigned segments, float thickness, float lod) {
+    draw::style ret{};
+    ret.num_segments = segments;
+    ret.thickness = thickness;
+    ret.lod_tolerance = lod;
+    return ret;
+}
+
+// mostly the same every frame, so most of it is encoded as unchanged deltas
+frame make_frame(uint64_t index) {
+    frame ret{};
+    ret.camera.view[3] = Vector4f{0.0f, -1.5f, -(float)index, 1.0f};
+    ret.camera.proj[0][0] = 1.2f;
+    ret.camera.proj[1][1] = 2.1f;
+    ret.camera.origin = Vector3f{0.0f, 1.5f, (float)index};
+    ret.camera.screen_size = Vector2f{1920.0f, 1080.0f};
+
+    const auto thin = make_style(16, 1.0f, 0.0f);
+    const auto thick = make_style(24 + (unsigned)index % 2, 2.5f, 0.5f);
+    const auto add = [&](draw::shape_type type, const draw::style &style,
+                         uint32_t seed) {
+        ret.primitives.push_back({type, style, false, {}, {}});
+        ret.primitives.back().record =
+            make_record(draw::record_size(type), seed);
+    };
+    add(draw::shape_type::sphere, thin, 1);
+    add(draw::shape_type::box, thin, 2);
+    add(draw::shape_type::sphere, thin, (uint32_t)index + 3);
+    add(draw::shape_type::cylinder, thick, 4);
+    add(draw::shape_type::capsule, thick, 5);
+
+    ret.primitives.push_back({draw::shape_type::box, thin, true, {}, {}});
+    auto &instances = ret.primitives.back();
+    instances.record = make_record(
+        capture::instance_record_size(draw::shape_type::box), 6);
+    // every float flips its sign bit, so a position takes 16 bytes
+    const auto count = index == dropped_frame
+                           ? capture::max_queued_bytes / 16 + 1
+                           : (size_t)index * 3 + 1;
+    for (size_t i = 0; i < count; i++) {
+        const auto sign = i % 2 == 0 ? 1.0f : -1.0f;
+        instances.positions.push_back(Vector3f{
+            sign * (float)(i + 1), sign * 2.0f, sign * (float)(index + 1)});
+    }
+    return ret;
+}
+
+void encode(const frame &frame) {
+    capture::begin_frame(frame.camera);
+    for (const auto &primitive : frame.primitives) {
+        g_core.num_segments = primitive.style.num_segments;
+        g_core.outline_tickness = primitive.style.thickness;
+        g_core.lod_tolerance = primitive.style.lod_tolerance;
+        if (primitive.instanced) {
+            capture::record_instances(primitive.type, primitive.record.data(),
+                                      primitive.positions);
+        } else {
+            capture::record(primitive.type, primitive.record.data());
+        }
+    }
+    capture::end_frame();
+}
+
+void compare(const capture::frame &decoded, const frame &expected,
+             uint64_t index) {
+    const auto &a = decoded.camera;
+    const auto &b = expected.camera;
+    check(decoded.index == index, "index", index);
+    check(same_bits(&a.view, &b.view, sizeof(a.view)) &&
+              same_bits(&a.proj, &b.proj, sizeof(a.proj)) &&
+              same_bits(&a.origin, &b.origin, sizeof(a.origin)) &&
+              same_bits(&a.forward, &b.forward, sizeof(a.forward)) &&
+              same_bits(&a.up, &b.up, sizeof(a.up)) &&
+              same_bits(&a.screen_size, &b.screen_size,
+                        sizeof(a.screen_size)),
+          "camera", index);
+
+    if (decoded.primitives.size() != expected.primitives.size()) {
+        check(false, "primitive count", index);
+        return;
+    }
+    for (size_t i = 0; i < decoded.primitives.size(); i++) {
+        const auto &got = decoded.primitives[i];
+        const auto &want = expected.primitives[i];
+        check(got.type == want.type && got.instanced == want.instanced,
+              "primitive type", index);
+
+        const auto has_style = got.style < decoded.styles.size();
+        check(has_style, "style index", index);
+        if (has_style) {
+            const auto &style = decoded.styles[got.style];
+            check(style.num_segments == want.style.num_segments &&
+                      style.thickness == want.style.thickness &&
+                      style.lod_tolerance == want.style.lod_tolerance,
+                  "style", index);
+        }
+
+        check(got.record + want.record.size() <= decoded.records.size() &&
+                  same_bits(decoded.records.data() + got.record,
+                            want.record.data(),
+                            sizeof(float) * want.record.size()),
+              "record", index);
+        if (got.instanced) {
+            check(got.count == want.positions.size() &&
+                      got.position + got.count <= decoded.positions.size() &&
+                      same_bits(decoded.positions.data() + got.position,
+                                want.positions.data(),
+                                sizeof(Vector3f) * want.positions.size()),
+                  "positions", index);
+        }
+    }
+}
+
+std::vector<uint8_t> read_file(const std::string &path) {
+    std::vector<uint8_t> ret;
+    const auto file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return ret;
+    }
+    std::vector<uint8_t> buffer(1 << 16);
+    size_t size{};
+    while ((size = std::fread(buffer.data(), 1, buffer.size(), file)) > 0) {
+        ret.insert(ret.end(), buffer.begin(), buffer.begin() + size);
+    }
+    std::fclose(file);
+    return ret;
+}
+
+void init_imgui() {
+    ImGui::CreateContext();
+    auto &io = ImGui::GetIO();
+    io.DisplaySize = ImVec2{1920.0f, 1080.0f};
+    io.DeltaTime = 1.0f / 60.0f;
+    unsigned char *pixels{};
+    int width{};
+    int height{};
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    ImGui::NewFrame();
+    g_core.drawlist = ImGui::GetBackgroundDrawList();
+}
+
+void new_frame() {
+    ImGui::Render();
+    ImGui::NewFrame();
+    g_core.drawlist = ImGui::GetBackgroundDrawList();
+}
+
+// one shape kept the way retained::draw_all keeps it, drawn once and then
+// replayed while the camera does not move
+struct retained_sphere {
+    draw::util::mesh mesh{};
+    bool dirty{true};
+    uint64_t camera_version{};
+
+    void draw() {
+        if (draw::util::replay_retained(mesh, dirty, camera_version)) {
+            return;
+        }
+        const auto capture = draw::util::begin_capture();
+        draw::draw_sphere(Vector3f{0.0f, 0.0f, -5.0f}, 1.0f, 0xFFFFFFFF, false,
+                          0);
+        dirty = !draw::util::end_capture(capture, mesh);
+        camera_version = g_core.camera_version;
+    }
+};
+
+void test_retained(const std::string &dir) {
+    // at the origin looking down -z
+    matrix_projection camera{};
+    camera.proj[2][2] = -1.0f;
+    camera.proj[2][3] = -1.0f;
+    camera.proj[3][2] = -0.1f;
+    camera.proj[3][3] = 0.0f;
+    camera.screen_size = Vector2f{1920.0f, 1080.0f};
+    g_core.projection = &camera;
+    g_core.camera_version++;
+
+    retained_sphere sphere{};
+    sphere.draw();
+    check(!sphere.dirty && !sphere.mesh.idx.empty(), "retained mesh", 0);
+
+    const auto path = dir + "/capture_retained.hbdc";
+    if (!capture::start(path.c_str())) {
+        check(false, "retained capture start", 0);
+        return;
+    }
+    for (uint64_t i = 0; i < retained_frames; i++) {
+        new_frame();
+        capture::begin_frame(camera);
+        sphere.draw();
+        capture::end_frame();
+    }
+    capture::stop();
+
+    const auto data = read_file(path);
+    std::remove(path.c_str());
+    capture::reader reader{};
+    if (!reader.open(data)) {
+        check(false, reader.error ? reader.error : "open", 0);
+        return;
+    }
+    capture::frame decoded{};
+    uint64_t index = 0;
+    while (reader.next(decoded)) {
+        check(decoded.primitives.size() == 1 &&
+                  decoded.primitives[0].type == draw::shape_type::sphere,
+              "retained shape missing", index);
+        index++;
+    }
+    check(reader.error == nullptr && index == retained_frames,
+          "retained frame count", index);
+
+    // replayed again once nothing is capturing
+    new_frame();
+    check(draw::util::replay_retained(sphere.mesh, sphere.dirty,
+                                      sphere.camera_version),
+          "retained replay", index);
+    g_core.projection = nullptr;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    const auto path =
+        std::string{argc > 1 ? argv[1] : "."} + "/capture_test.hbdc";
+    if (!capture::start(path.c_str())) {
+        std::fprintf(stderr, "can not open %s\n", path.c_str());
+        return 1;
+    }
+
+    std::vector<frame> frames;
+    for (uint64_t i = 0; i < frame_count; i++) {
+        frames.push_back(make_frame(i));
+        encode(frames.back());
+    }
+    const auto summary = capture::stop();
+    check(summary && summary->frames == frame_count - 1 &&
+              summary->dropped == 1 && summary->complete,
+          "writer summary", frame_count);
+
+    const auto data = read_file(path);
+    std::remove(path.c_str());
+    capture::reader reader{};
+    if (!reader.open(data)) {
+        std::fprintf(stderr, "%s\n", reader.error ? reader.error : "open");
+        return 1;
+    }
+
+    capture::frame decoded{};
+    uint64_t index = 0;
+    while (reader.next(decoded)) {
+        if (index == dropped_frame) {
+            index++;
+        }
+        if (index >= frame_count) {
+            check(false, "extra frame", index);
+            break;
+        }
+        compare(decoded, frames[index], index);
+        index++;
+    }
+    check(reader.error == nullptr, reader.error ? reader.error : "", index);
+    check(index == frame_count, "frame count", index);
+    check(reader.totals && reader.totals->frames == frame_count - 1 &&
+              reader.totals->dropped == 1,
+          "end chunk", index);
+
+    init_imgui();
+    test_retained(argc > 1 ? argv[1] : ".");
+
+    if (g_failures != 0) {
+        std::fprintf(stderr, "%d checks failed\n", g_failures);
+        return 1;
+    }
+    std::printf("%llu frames round tripped, 1 dropped\n",
+                (unsigned long long)frame_count - 1);
+    return 0;
+}
@@ -0,0 +1,185 @@
+// hull::build on point sets with a known answer: a cube keeps its quads, a
+// tetrahedron its triangles, coplanar points have no hull and a sampled
+// sphere has to be a closed surface, V - E + F = 2
+//
+// > hb_draw_hull_test
+
+#include "hull.h"
+#include "math_types.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <vector>
+
+namespace {
+int g_failures{};
+
+void check(bool ok, const char *test, const char *what) {
+    if (!ok) {
+        std::fprintf(stderr, "%s: %s\n", test, what);
+        g_failures++;
+    }
+}
+
+// faces wind counter clockwise seen from outside, and every edge joins two
+// different faces that both have it
+void check_mesh(const char *test, const hull::mesh &mesh) {
+    Vector3f center{0.0f};
+    for (const auto &v : mesh.vertices) {
+        center += v;
+    }
+    center /= (float)mesh.vertices.size();
+
+    bool outward = true;
+    bool in_range = true;
+    for (const auto &face : mesh.faces) {
+        if (face.count < 3 || face.first + face.count > mesh.indices.size()) {
+            in_range = false;
+            continue;
+        }
+        const auto &a = mesh.vertices[mesh.indices[face.first]];
+        const auto &b = mesh.vertices[mesh.indices[face.first + 1]];
+        const auto &c = mesh.vertices[mesh.indices[face.first + 2]];
+        outward = outward && glm::dot(glm::cross(b - a, c - a), a - center) > 0;
+    }
+    check(in_range, test, "face indices");
+    check(outward, test, "face winding");
+
+    const auto has_edge = [&](const hull::face &face, uint32_t a, uint32_t b) {
+        for (uint32_t i = 0; i < face.count; i++) {
+            const auto p = mesh.indices[face.first + i];
+            const auto q = mesh.indices[face.first + (i + 1) % face.count];
+            if ((p == a && q == b) || (p == b && q == a)) {
+                return true;
+            }
+        }
+        return false;
+    };
+    bool edges_ok = in_range;
+    for (const auto &edge : mesh.edges) {
+        edges_ok = edges_ok && edge.left != edge.right &&
+                   edge.left < mesh.faces.size() &&
+                   edge.right < mesh.faces.size() &&
+                   has_edge(mesh.faces[edge.left], edge.a, edge.b) &&
+                   has_edge(mesh.faces[edge.right], edge.a, edge.b);
+    }
+    check(edges_ok, test, "edge faces");
+}
+
+std::optional<hull::mesh> build(const char *test,
+                                const std::vector<Vector3f> &points) {
+    auto ret = hull::build(points);
+    check(ret.has_value(), test, "no hull");
+    if (ret) {
+        check_mesh(test, *ret);
+    }
+    return ret;
+}
+
+// corners, face centers and inner points, only the corners are on the hull
+void test_cube() {
+    std::vector<Vector3f> points;
+    for (int i = 0; i < 8; i++) {
+        points.push_back(Vector3f{i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f,
+                                  i & 4 ? 1.0f : -1.0f});
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        for (const auto side : {-1.0f, 1.0f}) {
+            Vector3f p{0.0f};
+            p[axis] = side;
+            points.push_back(p);
+        }
+    }
+    points.push_back(Vector3f{0.1f, -0.2f, 0.3f});
+    points.push_back(Vector3f{-0.5f, 0.5f, 0.0f});
+
+    const auto mesh = build("cube", points);
+    if (!mesh) {
+        return;
+    }
+    check(mesh->vertices.size() == 8, "cube", "vertex count");
+    check(mesh->faces.size() == 6, "cube", "face count");
+    check(mesh->edges.size() == 12, "cube", "edge count");
+    for (const auto &face : mesh->faces) {
+        check(face.count == 4, "cube", "face is not a quad");
+    }
+}
+
+void test_tetrahedron() {
+    const std::vector<Vector3f> points{
+        {1.0f, 1.0f, 1.0f},
+        {1.0f, -1.0f, -1.0f},
+        {-1.0f, 1.0f, -1.0f},
+        {-1.0f, -1.0f, 1.0f},
+        // inside
+        {0.1f, 0.0f, -0.1f},
+    };
+    const auto mesh = build("tetrahedron", points);
+    if (!mesh) {
+        return;
+    }
+    check(mesh->vertices.size() == 4, "tetrahedron", "vertex count");
+    check(mesh->faces.size() == 4, "tetrahedron", "face count");
+    check(mesh->edges.size() == 6, "tetrahedron", "edge count");
+    for (const auto &face : mesh->faces) {
+        check(face.count == 3, "tetrahedron", "face is not a triangle");
+    }
+}
+
+void test_degenerate() {
+    std::vector<Vector3f> plane;
+    for (int x = 0; x < 5; x++) {
+        for (int y = 0; y < 5; y++) {
+            plane.push_back(Vector3f{(float)x, 2.0f * y - x, 3.0f});
+        }
+    }
+    check(!hull::build(plane), "coplanar", "has a hull");
+
+    const std::vector<Vector3f> line{
+        {0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}, {2.0f, 2.0f, 2.0f},
+        {3.0f, 3.0f, 3.0f}, {4.0f, 4.0f, 4.0f}};
+    check(!hull::build(line), "collinear", "has a hull");
+
+    const std::vector<Vector3f> three{
+        {0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+    check(!hull::build(three), "three points", "has a hull");
+}
+
+// every point of a fibonacci sphere is on its hull
+void test_sphere() {
+    constexpr size_t count = 500;
+    const auto golden_angle = glm::radians(180.0f) * (3.0f - std::sqrt(5.0f));
+    std::vector<Vector3f> points;
+    for (size_t i = 0; i < count; i++) {
+        const auto y = 1.0f - 2.0f * (i + 0.5f) / count;
+        const auto r = std::sqrt(1.0f - y * y);
+        const auto a = golden_angle * i;
+        points.push_back(Vector3f{std::cos(a) * r, y, std::sin(a) * r} * 2.0f);
+    }
+
+    const auto mesh = build("sphere", points);
+    if (!mesh) {
+        return;
+    }
+    const auto v = (long long)mesh->vertices.size();
+    const auto e = (long long)mesh->edges.size();
+    const auto f = (long long)mesh->faces.size();
+    check(v == (long long)count, "sphere", "vertex count");
+    check(v - e + f == 2, "sphere", "euler characteristic");
+}
+} // namespace
+
+int main() {
+    test_cube();
+    test_tetrahedron();
+    test_degenerate();
+    test_sphere();
+    if (g_failures != 0) {
+        std::fprintf(stderr, "%d checks failed\n", g_failures);
+        return 1;
+    }
+    std::printf("hull tests passed\n");
+    return 0;
+}
@@ -0,0 +1,105 @@
+// matrix_projection::project against hand computed screen positions, and
+// against a subclass that overrides the batch path the way the game camera
+// does. the kernel must not dispatch to the override, or checking the
+// kernel against the override compares the override with itself
+//
+// > hb_draw_projection_test
+
+#include "math_types.h"
+#include "projection.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+
+namespace {
+int g_failures{};
+
+void check(bool ok, const char *test, const char *what) {
+    if (!ok) {
+        std::fprintf(stderr, "%s: %s\n", test, what);
+        g_failures++;
+    }
+}
+
+// every point lands on the same pixel, nothing like the kernel
+struct override_projection : matrix_projection {
+    void world_to_screen(const float *, const float *, const float *,
+                         size_t count, Vector2f *out,
+                         uint8_t *visible) override {
+        for (size_t i = 0; i < count; i++) {
+            out[i] = Vector2f{-1.0f, -1.0f};
+            visible[i] = 1;
+        }
+        batch_calls++;
+    }
+
+    int batch_calls{};
+};
+
+// at the origin looking down -z, 90 degree fov on a 100x100 screen, so a
+// point at depth d lands 50 / d pixels per unit from the center
+template <typename T> T make_camera() {
+    T ret{};
+    ret.proj[2][2] = -1.0f;
+    ret.proj[2][3] = -1.0f;
+    ret.proj[3][2] = -0.1f;
+    ret.proj[3][3] = 0.0f;
+    ret.screen_size = Vector2f{100.0f, 100.0f};
+    return ret;
+}
+
+bool same(const std::optional<Vector2f> &a, const std::optional<Vector2f> &b) {
+    return a.has_value() == b.has_value() && (!a || *a == *b);
+}
+
+void test_kernel() {
+    const auto camera = make_camera<matrix_projection>();
+    const auto pos = camera.project(Vector3f{1.0f, 0.5f, -2.0f});
+    check(pos && *pos == Vector2f{75.0f, 37.5f}, "kernel", "screen position");
+    check(!camera.project(Vector3f{0.0f, 0.0f, 2.0f}), "kernel",
+          "visible behind the camera");
+
+    const float x[]{1.0f, -3.0f, 0.0f};
+    const float y[]{0.5f, 2.0f, 0.0f};
+    const float z[]{-2.0f, -4.0f, 2.0f};
+    Vector2f out[3]{};
+    uint8_t visible[3]{};
+    camera.project(x, y, z, 3, out, visible);
+    for (size_t i = 0; i < 3; i++) {
+        const auto single = camera.project(Vector3f{x[i], y[i], z[i]});
+        check(same(single, visible[i] ? std::optional{out[i]} : std::nullopt),
+              "kernel", "batch and single differ");
+    }
+}
+
+void test_override() {
+    auto camera = make_camera<override_projection>();
+    projection &base = camera;
+    const Vector3f pos{1.0f, 0.5f, -2.0f};
+
+    Vector2f overridden{};
+    uint8_t visible{};
+    base.world_to_screen(&pos.x, &pos.y, &pos.z, 1, &overridden, &visible);
+    check(camera.batch_calls == 1 && visible, "override", "not dispatched");
+
+    const auto kernel = camera.project(pos);
+    const auto single = base.world_to_screen(pos);
+    check(camera.batch_calls == 1, "override", "kernel called the override");
+    check(kernel && *kernel != overridden, "override",
+          "kernel matches the override");
+    check(same(kernel, single), "override", "single point is not the kernel");
+}
+} // namespace
+
+int main() {
+    test_kernel();
+    test_override();
+    if (g_failures != 0) {
+        std::fprintf(stderr, "%d checks failed\n", g_failures);
+        return 1;
+    }
+    std::printf("projection tests passed\n");
+    return 0;
+}
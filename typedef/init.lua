@@ -1,15 +1,135 @@
 ---@meta
 
 ---@class hb_draw
----@field cylinder fun(start: Vector3f, end: Vector3f, radius: number, color: integer, outline: boolean, color_outline: integer)
----@field ring fun(start: Vector3f, end: Vector3f, radius_a: number, radius_b: number, color: integer, outline: boolean, color_outline: integer)
----@field sphere fun(center: Vector3f, radius: number, color: integer, outline: boolean, color_outline: integer)
----@field box fun(pos: Vector3f, extent: Vector3f, rot: Matrix4x4f, color: integer, outline: boolean, color_outline: integer)
----@field triangle fun(pos: Vector3f, extent: Vector3f, rot: Matrix4x4f, color: integer, outline: boolean, color_outline: integer)
----@field capsule fun(start: Vector3f, end: Vector3f, radius: number, color: integer, outline: boolean, color_outline: integer)
+---@field cylinder fun(start: Vector3f, end: Vector3f, radius: number, color: integer, outline: boolean, color_outline: integer) | fun(start: Vector3f, end: Vector3f, radius: number, style: hb_draw_style)
+---@field ring fun(start: Vector3f, end: Vector3f, radius_a: number, radius_b: number, color: integer, outline: boolean, color_outline: integer) | fun(start: Vector3f, end: Vector3f, radius_a: number, radius_b: number, style: hb_draw_style)
+---@field sphere fun(center: Vector3f, radius: number, color: integer, outline: boolean, color_outline: integer) | fun(center: Vector3f, radius: number, style: hb_draw_style)
+---@field ellipsoid fun(center: Vector3f, radii: Vector3f, rot: Matrix4x4f | Matrix3x3f | Quaternion, color: integer, outline: boolean, color_outline: integer) | fun(center: Vector3f, radii: Vector3f, rot: Matrix4x4f | Matrix3x3f | Quaternion, style: hb_draw_style)
+---@field cone fun(start: Vector3f, end: Vector3f, radius_start: number, radius_end: number, color: integer, outline: boolean, color_outline: integer) | fun(start: Vector3f, end: Vector3f, radius_start: number, radius_end: number, style: hb_draw_style)
+---@field box fun(pos: Vector3f, extent: Vector3f, rot: Matrix4x4f | Matrix3x3f | Quaternion, color: integer, outline: boolean, color_outline: integer) | fun(pos: Vector3f, extent: Vector3f, rot: Matrix4x4f | Matrix3x3f | Quaternion, style: hb_draw_style)
+---@field triangle fun(pos: Vector3f, extent: Vector3f, rot: Matrix4x4f | Matrix3x3f | Quaternion, color: integer, outline: boolean, color_outline: integer) | fun(pos: Vector3f, extent: Vector3f, rot: Matrix4x4f | Matrix3x3f | Quaternion, style: hb_draw_style)
+---@field capsule fun(start: Vector3f, end: Vector3f, radius: number, color: integer, outline: boolean, color_outline: integer) | fun(start: Vector3f, end: Vector3f, radius: number, style: hb_draw_style)
+---@field cylinders fun(list: any[] | number[])
+---@field rings fun(list: any[] | number[])
+---@field spheres fun(list: any[] | number[])
+---@field ellipsoids fun(list: any[] | number[])
+---@field cones fun(list: any[] | number[])
+---@field lines fun(points: Vector3f[] | number[], colors: integer | integer[])
+---@field arrows fun(points: Vector3f[] | number[], colors: integer | integer[], head_size: number?)
+---@field labels fun(positions: Vector3f[] | number[], strings: (string | number)[], colors: integer | integer[], size: number?)
+---@field axes fun(pos: Vector3f, rot: Matrix4x4f | Quaternion, size: number)
+---@field boxes fun(list: any[] | number[])
+---@field triangles fun(list: any[] | number[])
+---@field capsules fun(list: any[] | number[])
+---@field sphere_instances fun(radius: number, positions: Vector3f[] | number[], color: integer, outline: boolean, color_outline: integer) | fun(radius: number, positions: Vector3f[] | number[], style: hb_draw_style)
+---@field box_instances fun(extent: Vector3f, rot: Matrix4x4f | Quaternion, positions: Vector3f[] | number[], color: integer, outline: boolean, color_outline: integer) | fun(extent: Vector3f, rot: Matrix4x4f | Quaternion, positions: Vector3f[] | number[], style: hb_draw_style)
+---@field triangle_instances fun(extent: Vector3f, rot: Matrix4x4f | Quaternion, positions: Vector3f[] | number[], color: integer, outline: boolean, color_outline: integer) | fun(extent: Vector3f, rot: Matrix4x4f | Quaternion, positions: Vector3f[] | number[], style: hb_draw_style)
+---@field new_buffer fun(kind: "sphere" | "box" | "triangle" | "cylinder" | "ring" | "capsule" | "ellipsoid" | "cone", capacity: integer): hb_draw_buffer?
+---@field draw_buffer fun(buf: hb_draw_buffer, count: integer)
+---@field create_cylinder fun(start: Vector3f, end: Vector3f, radius: number, color: integer, outline: boolean, color_outline: integer): hb_draw_shape
+---@field create_ring fun(start: Vector3f, end: Vector3f, radius_a: number, radius_b: number, color: integer, outline: boolean, color_outline: integer): hb_draw_shape
+---@field create_sphere fun(center: Vector3f, radius: number, color: integer, outline: boolean, color_outline: integer): hb_draw_shape
+---@field create_box fun(pos: Vector3f, extent: Vector3f, rot: Matrix4x4f, color: integer, outline: boolean, color_outline: integer): hb_draw_shape
+---@field create_triangle fun(pos: Vector3f, extent: Vector3f, rot: Matrix4x4f, color: integer, outline: boolean, color_outline: integer): hb_draw_shape
+---@field create_capsule fun(start: Vector3f, end: Vector3f, radius: number, color: integer, outline: boolean, color_outline: integer): hb_draw_shape
+---@field create_ellipsoid fun(center: Vector3f, radii: Vector3f, rot: Matrix4x4f, color: integer, outline: boolean, color_outline: integer): hb_draw_shape
+---@field create_cone fun(start: Vector3f, end: Vector3f, radius_start: number, radius_end: number, color: integer, outline: boolean, color_outline: integer): hb_draw_shape
+---@field create_hull fun(points: Vector3f[], color: integer, outline: boolean, color_outline: integer): hb_draw_shape?
+---@field create_trail fun(max_points: integer): hb_draw_shape
+---@field attach_cylinder fun(transform: REManagedObject | integer, joint_name: string?, local_start: Vector3f, local_end: Vector3f, radius: number, color: integer, outline: boolean, color_outline: integer): hb_draw_shape?
+---@field attach_ring fun(transform: REManagedObject | integer, joint_name: string?, local_start: Vector3f, local_end: Vector3f, radius_a: number, radius_b: number, color: integer, outline: boolean, color_outline: integer): hb_draw_shape?
+---@field attach_sphere fun(transform: REManagedObject | integer, joint_name: string?, local_center: Vector3f, radius: number, color: integer, outline: boolean, color_outline: integer): hb_draw_shape?
+---@field attach_box fun(transform: REManagedObject | integer, joint_name: string?, local_pos: Vector3f, extent: Vector3f, local_rot: Matrix4x4f, color: integer, outline: boolean, color_outline: integer): hb_draw_shape?
+---@field attach_triangle fun(transform: REManagedObject | integer, joint_name: string?, local_pos: Vector3f, extent: Vector3f, local_rot: Matrix4x4f, color: integer, outline: boolean, color_outline: integer): hb_draw_shape?
+---@field attach_capsule fun(transform: REManagedObject | integer, joint_name: string?, local_start: Vector3f, local_end: Vector3f, radius: number, color: integer, outline: boolean, color_outline: integer): hb_draw_shape?
+---@field attach_ellipsoid fun(transform: REManagedObject | integer, joint_name: string?, local_center: Vector3f, radii: Vector3f, local_rot: Matrix4x4f, color: integer, outline: boolean, color_outline: integer): hb_draw_shape?
+---@field attach_cone fun(transform: REManagedObject | integer, joint_name: string?, local_start: Vector3f, local_end: Vector3f, radius_start: number, radius_end: number, color: integer, outline: boolean, color_outline: integer): hb_draw_shape?
+---@field style fun(params: {fill: integer?, outline: integer | false | nil, thickness: number?, segments: integer?, lod_tolerance: number?}): hb_draw_style
+---@field begin_list fun()
+---@field end_list fun(): hb_draw_list?
+---@field draw_list fun(list: hb_draw_list, transform: Matrix4x4f?)
+---@field frame_stats fun(n: integer?): hb_draw_frame_stats[]
+---@field set_cache fun(enabled: boolean, max_age: integer?)
+---@field get_stats fun(): table<string, hb_draw_stats>
+---@field dump_trace fun(path: string, frames: integer?): boolean
+---@field start_capture fun(path: string): boolean
+---@field stop_capture fun(): hb_draw_capture_summary?
+---@field set_budget fun(max_shapes: integer, script_name: string?)
+---@field set_priority fun(priority: integer)
 ---@field set_num_segments fun(num: integer)
----@field set_outline_tickness fun(num: integer)
+---@field set_outline_tickness fun(num: number)
 ---@field set_w2s fun(b: boolean)
 
+---@class hb_draw_shape
+---@field set_position fun(self: hb_draw_shape, pos: Vector3f)
+---@field set_start fun(self: hb_draw_shape, start: Vector3f)
+---@field set_end fun(self: hb_draw_shape, end: Vector3f)
+---@field set_extent fun(self: hb_draw_shape, extent: Vector3f)
+---@field set_rotation fun(self: hb_draw_shape, rot: Matrix4x4f)
+---@field set_radius fun(self: hb_draw_shape, radius: number)
+---@field set_radius_b fun(self: hb_draw_shape, radius: number)
+---@field set_color fun(self: hb_draw_shape, color: integer)
+---@field set_outline fun(self: hb_draw_shape, outline: boolean, color_outline: integer)
+---@field set_style fun(self: hb_draw_shape, style: hb_draw_style?)
+---@field set_visible fun(self: hb_draw_shape, visible: boolean)
+---@field is_visible fun(self: hb_draw_shape): boolean
+---@field push fun(self: hb_draw_shape, pos: Vector3f, width: number, color: integer)
+---@field clear_points fun(self: hb_draw_shape)
+---@field destroy fun(self: hb_draw_shape)
+
+---@class hb_draw_list
+---@field get_count fun(self: hb_draw_list): integer
+
+---@class hb_draw_frame_stats
+---@field shapes {sphere: integer, box: integer, triangle: integer, cylinder: integer, ring: integer, capsule: integer, ellipsoid: integer, cone: integer, hull: integer, trail: integer, lines: integer, labels: integer}
+---@field culled integer
+---@field replayed integer
+---@field projections integer
+---@field managed_calls integer
+---@field vertices integer
+---@field indices integer
+---@field cache_hits integer
+---@field cache_misses integer
+---@field cache_entries integer
+---@field allocations hb_draw_allocations
+---@field allocated_bytes hb_draw_allocations
+---@field camera_us number
+---@field construct_us number
+---@field emit_us number
+---@field render_us number
+
+---@class hb_draw_allocations
+---@field other integer
+---@field construct integer
+---@field drawlist integer
+---@field binding integer
+
+---@class hb_draw_stats
+---@field submitted integer
+---@field culled integer
+---@field drawn integer
+---@field dropped integer
+---@field vertices integer
+---@field us number
+---@field budget integer
+---@field priority integer
+
+---@class hb_draw_capture_summary
+---@field frames integer
+---@field dropped integer
+---@field complete boolean
+
+---@class hb_draw_style
+---@field set_fill fun(self: hb_draw_style, color: integer)
+---@field set_outline fun(self: hb_draw_style, color_outline: integer | false | nil)
+---@field set_thickness fun(self: hb_draw_style, thickness: number)
+---@field set_segments fun(self: hb_draw_style, num: integer)
+---@field set_lod_tolerance fun(self: hb_draw_style, tolerance: number)
+
+---@class hb_draw_buffer
+---@field set fun(self: hb_draw_buffer, i: integer, ...)
+---@field get_capacity fun(self: hb_draw_buffer): integer
+---@field get_record_size fun(self: hb_draw_buffer): integer
+
 ---@class hb_draw
 hb_draw = {}